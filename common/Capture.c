@@ -0,0 +1,83 @@
+//*****************************************************************************
+//
+//	Capture.c
+//
+//		Record sensor and interrupt activity for replay on the host
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "Drivers/uartstdio.h"
+
+#include "Capture.h"
+
+extern volatile int long xPortSysTickCount;
+
+volatile unsigned long g_bCaptureActive;
+
+static tCaptureEvent g_psCapture[CAPTURE_EVENTS];
+static volatile unsigned long g_ulCaptureCount;
+
+//*****************************************************************************
+//
+//	Throw away any earlier capture and start recording.
+//
+//*****************************************************************************
+void CaptureStart( void ) {
+	g_bCaptureActive = 0;
+	g_ulCaptureCount = 0;
+	g_bCaptureActive = 1;
+}
+
+//*****************************************************************************
+//
+//	Append one event. Called from tasks and ISRs, so the slot is claimed
+//	with interrupts off.
+//
+//*****************************************************************************
+void CaptureRecord( unsigned long ulType, unsigned long ulValue, unsigned long ulTimer ) {
+	tBoolean bWasDisabled;
+	tCaptureEvent *psEvent;
+
+	bWasDisabled = IntMasterDisable();
+	if ( g_ulCaptureCount < CAPTURE_EVENTS ) {
+		psEvent = &g_psCapture[g_ulCaptureCount++];
+		psEvent->ulTick = xPortSysTickCount;
+		psEvent->usTimer = ulTimer;
+		psEvent->ucType = ulType;
+		psEvent->ucValue = ulValue;
+	}
+	if ( g_ulCaptureCount == CAPTURE_EVENTS ) {
+		g_bCaptureActive = 0;
+	}
+	if ( !bWasDisabled ) {
+		IntMasterEnable();
+	}
+}
+
+unsigned long CaptureCount( void ) {
+	return g_ulCaptureCount;
+}
+
+//*****************************************************************************
+//
+//	Stop recording and print the buffer, one "capture:" line per event.
+//	The caller owns UART0 for the duration.
+//
+//*****************************************************************************
+void CaptureDump( void ) {
+	unsigned long ulIdx;
+
+	g_bCaptureActive = 0;
+
+	UARTprintf( "capture: begin %u\n", g_ulCaptureCount );
+	for ( ulIdx = 0; ulIdx < g_ulCaptureCount; ulIdx++ ) {
+		UARTprintf( "capture: %08x %04x %02x %02x\n",
+					g_psCapture[ulIdx].ulTick, g_psCapture[ulIdx].usTimer,
+					g_psCapture[ulIdx].ucType, g_psCapture[ulIdx].ucValue );
+	}
+	UARTprintf( "capture: end\n" );
+}
@@ -0,0 +1,70 @@
+//*****************************************************************************
+//
+//	Capture.h
+//
+//		Record sensor and interrupt activity for replay on the host
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Capture the raw timer values, GPIO edges and ISR
+//						entries the lab code sees, in the order it sees them,
+//						so tools/replay can feed the same inputs back into
+//						ProxySensor() and Task_TimeOfDay() on the host.
+//
+//		Notes:			Events go into a fixed RAM buffer. Recording stops when
+//						the buffer is full; CaptureDump() then prints it on
+//						UART0 as "capture:" lines for the replay tool to read.
+//
+//*****************************************************************************
+
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+//*****************************************************************************
+//
+//	Event types
+//
+//*****************************************************************************
+#define CAPTURE_PING			1		// A PING measurement starts
+#define CAPTURE_EDGE			2		// Code saw the PING line change, ucValue = new level
+#define CAPTURE_TIMER			3		// Code read Timer_0_A, usTimer = value read
+#define CAPTURE_ISR				4		// Interrupt entry, ucValue = CAPTURE_ISR_*
+
+#define CAPTURE_ISR_TIMER_0_A	0
+
+//*****************************************************************************
+//
+//	One 8 byte event. ulTick is the FreeRTOS tick count when it was taken.
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned long	ulTick;
+	unsigned short	usTimer;
+	unsigned char	ucType;
+	unsigned char	ucValue;
+} tCaptureEvent;
+
+#define CAPTURE_EVENTS			512
+
+//*****************************************************************************
+//
+//	Record an event if a capture is running. The arguments are not evaluated
+//	otherwise, so a TimerValueGet() in them costs nothing when idle.
+//
+//*****************************************************************************
+#define CAPTURE_EVENT( ucType, ucValue, usTimer )						\
+	do {																\
+		if ( g_bCaptureActive ) {										\
+			CaptureRecord( ( ucType ), ( ucValue ), ( usTimer ) );		\
+		}																\
+	} while ( 0 )
+
+extern volatile unsigned long g_bCaptureActive;
+
+extern void CaptureStart( void );
+extern void CaptureRecord( unsigned long ulType, unsigned long ulValue, unsigned long ulTimer );
+extern unsigned long CaptureCount( void );
+extern void CaptureDump( void );
+
+#endif // __CAPTURE_H__
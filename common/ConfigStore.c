@@ -0,0 +1,292 @@
+//*****************************************************************************
+//
+//	ConfigStore.c
+//
+//		Persistent configuration and calibration values in on-chip flash
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Key/value store kept as an append-only log in the top
+//						4 KB of flash, loaded into RAM in one pass at boot.
+//
+//		Notes:			The region is split in two banks of two 1 KB erase
+//						pages. Each bank starts with a header
+//
+//							sequence | CONFIG_MAGIC
+//
+//						followed by 8 byte records
+//
+//							key | crc16 << 16, value
+//
+//						A set appends one record to the active bank. When the
+//						bank is full, the current values are compacted into the
+//						other bank and its header is written last, so a power
+//						loss during compaction leaves the old bank in charge.
+//						The other bank's magic is cleared before it is erased,
+//						so a torn erase cannot leave a stale header valid.
+//						A record torn by a power loss fails its CRC and is
+//						skipped, leaving the previous value for that key.
+//						Banks take turns being erased, which spreads the wear.
+//
+//						The linker command file must keep code out of
+//						CONFIG_FLASH_BASE and above.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/flash.h"
+#include "driverlib/sysctl.h"
+
+#include "ConfigStore.h"
+
+//*****************************************************************************
+//
+//	Flash layout. The LM3S1968 has 256 KB of flash in 1 KB erase pages.
+//
+//*****************************************************************************
+#define CONFIG_FLASH_BASE		0x0003F000
+#define CONFIG_PAGE_SIZE		1024
+#define CONFIG_BANK_SIZE		( 2 * CONFIG_PAGE_SIZE )
+#define CONFIG_MAGIC			0x31474643		// "CFG1"
+#define CONFIG_ERASED			0xFFFFFFFF
+
+#define BANK_BASE( ulBank )		( CONFIG_FLASH_BASE + ( ulBank ) * CONFIG_BANK_SIZE )
+
+//*****************************************************************************
+//
+//	Default value and limits for each key. The defaults are the constants
+//	that used to be compiled into the labs, except the PING period, which
+//	matches the rate monotonic analysis in lab 6's TaskSet.h. Its minimum is
+//	the shortest period that analysis still passes with.
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned long	ulDefault;
+	unsigned long	ulMin;
+	unsigned long	ulMax;
+} tConfigLimits;
+
+static const tConfigLimits g_psConfigLimits[CFG_COUNT] =
+{
+	{ 60,		50,			1000 },			// CFG_PING_PERIOD
+	{ 1,		0,			1 },			// CFG_STREAM
+	{ 4,		4,			16 },			// CFG_SYSDIV
+	{ 50000,	1,			0xFFFF },		// CFG_TIMER_LOAD
+	{ 9,		0,			0xFF },			// CFG_TIMER_PRESCALE
+	{ 100,		1,			100000 },		// CFG_PING_SETTLE
+	{ 60,		1,			100000 },		// CFG_PING_PULSE
+	{ 1000000,	100000,		4000000 },		// CFG_OLED_FREQUENCY
+	{ 1,		0,			1 }				// CFG_GOVERNOR
+};
+
+static volatile unsigned long g_pulConfig[CFG_COUNT];
+
+static unsigned long g_ulBank;				// Bank holding the live log
+static unsigned long g_ulSequence;			// Its header sequence number
+static unsigned long g_ulNextRecord;		// Address of the first free record
+
+//*****************************************************************************
+//
+//	CRC-16/CCITT over the key (2 bytes) and value (4 bytes), little endian.
+//
+//*****************************************************************************
+static unsigned long ConfigCrc( unsigned long ulKey, unsigned long ulValue ) {
+	unsigned char pucData[6];
+	unsigned long ulCrc = 0xFFFF;
+	unsigned long ulIdx;
+	unsigned long ulBit;
+
+	pucData[0] = ulKey;
+	pucData[1] = ulKey >> 8;
+	pucData[2] = ulValue;
+	pucData[3] = ulValue >> 8;
+	pucData[4] = ulValue >> 16;
+	pucData[5] = ulValue >> 24;
+
+	for ( ulIdx = 0; ulIdx < 6; ulIdx++ ) {
+		ulCrc ^= pucData[ulIdx] << 8;
+		for ( ulBit = 0; ulBit < 8; ulBit++ ) {
+			ulCrc = ( ulCrc & 0x8000 ) ? ( ( ulCrc << 1 ) ^ 0x1021 ) : ( ulCrc << 1 );
+		}
+	}
+	return ulCrc & 0xFFFF;
+}
+
+static long ConfigValid( unsigned long ulKey, unsigned long ulValue ) {
+	return ( ulKey < CFG_COUNT &&
+			 ulValue >= g_psConfigLimits[ulKey].ulMin &&
+			 ulValue <= g_psConfigLimits[ulKey].ulMax );
+}
+
+//*****************************************************************************
+//
+//	Program one record at ulAddress.
+//
+//*****************************************************************************
+static long ConfigWriteRecord( unsigned long ulAddress, unsigned long ulKey, unsigned long ulValue ) {
+	unsigned long pulRecord[2];
+
+	pulRecord[0] = ulKey | ( ConfigCrc( ulKey, ulValue ) << 16 );
+	pulRecord[1] = ulValue;
+
+	return FlashProgram( pulRecord, ulAddress, sizeof( pulRecord ) );
+}
+
+//*****************************************************************************
+//
+//	Copy the live values into the other bank and make it the active one.
+//	Only values that differ from their default need a record.
+//
+//*****************************************************************************
+static long ConfigCompact( void ) {
+	unsigned long ulBank = g_ulBank ^ 1;
+	unsigned long ulAddress;
+	unsigned long pulHeader[2];
+	unsigned long ulKey;
+
+	FlashUsecSet( SysCtlClockGet() / 1000000 );
+
+	// An erase cut short leaves some bits still 0. The stale header's magic
+	// survives that, and its sequence number can gain bits and win at the
+	// next boot. With the magic cleared first, a torn erase would have to
+	// set exactly the magic's bits to bring the header back.
+	if ( HWREG( BANK_BASE( ulBank ) + 4 ) == CONFIG_MAGIC ) {
+		pulHeader[1] = 0;
+		if ( FlashProgram( &pulHeader[1], BANK_BASE( ulBank ) + 4, sizeof( pulHeader[1] ) ) ) {
+			return CONFIG_ERR_FLASH;
+		}
+	}
+
+	for ( ulAddress = BANK_BASE( ulBank ); ulAddress < BANK_BASE( ulBank ) + CONFIG_BANK_SIZE; ulAddress += CONFIG_PAGE_SIZE ) {
+		if ( FlashErase( ulAddress ) ) {
+			return CONFIG_ERR_FLASH;
+		}
+	}
+
+	ulAddress = BANK_BASE( ulBank ) + 8;
+	for ( ulKey = 0; ulKey < CFG_COUNT; ulKey++ ) {
+		if ( g_pulConfig[ulKey] != g_psConfigLimits[ulKey].ulDefault ) {
+			if ( ConfigWriteRecord( ulAddress, ulKey, g_pulConfig[ulKey] ) ) {
+				return CONFIG_ERR_FLASH;
+			}
+			ulAddress += 8;
+		}
+	}
+
+	// Header goes last. Until it is programmed the old bank is still the newest valid one.
+	pulHeader[0] = g_ulSequence + 1;
+	pulHeader[1] = CONFIG_MAGIC;
+	if ( FlashProgram( pulHeader, BANK_BASE( ulBank ), sizeof( pulHeader ) ) ) {
+		return CONFIG_ERR_FLASH;
+	}
+
+	g_ulBank = ulBank;
+	g_ulSequence = pulHeader[0];
+	g_ulNextRecord = ulAddress;
+
+	return CONFIG_OK;
+}
+
+//*****************************************************************************
+//
+//	Load the store into RAM. Picks the newest bank with a valid header and
+//	replays its log once; later records for a key override earlier ones.
+//	Never writes flash: it runs before the PLL clock is set, and
+//	FlashUsecSet() would be given the wrong clock.
+//
+//*****************************************************************************
+void ConfigInit( void ) {
+	unsigned long ulAddress;
+	unsigned long ulWord0;
+	unsigned long ulWord1;
+	unsigned long ulKey;
+	long lValid0;
+	long lValid1;
+
+	for ( ulKey = 0; ulKey < CFG_COUNT; ulKey++ ) {
+		g_pulConfig[ulKey] = g_psConfigLimits[ulKey].ulDefault;
+	}
+
+	lValid0 = ( HWREG( BANK_BASE( 0 ) + 4 ) == CONFIG_MAGIC );
+	lValid1 = ( HWREG( BANK_BASE( 1 ) + 4 ) == CONFIG_MAGIC );
+
+	if ( !lValid0 && !lValid1 ) {
+		// Blank or corrupt region, run on the defaults. A full "bank 1" makes
+		// the first ConfigSet() compact, which formats bank 0.
+		g_ulBank = 1;
+		g_ulSequence = 0;
+		g_ulNextRecord = BANK_BASE( 1 ) + CONFIG_BANK_SIZE;
+		return;
+	}
+
+	// Sequence numbers are compared with wraparound: bank 1 is newer if it is
+	// 1 to 2^31 - 1 ahead. Masked so the test holds whatever the width of long.
+	if ( lValid0 && lValid1 ) {
+		ulWord0 = HWREG( BANK_BASE( 0 ) );
+		ulWord1 = HWREG( BANK_BASE( 1 ) );
+		g_ulBank = ( ( ( ulWord1 - ulWord0 ) & 0xFFFFFFFF ) - 1 < 0x7FFFFFFF );
+	}
+	else {
+		g_ulBank = lValid1;
+	}
+	g_ulSequence = HWREG( BANK_BASE( g_ulBank ) );
+
+	for ( ulAddress = BANK_BASE( g_ulBank ) + 8; ulAddress < BANK_BASE( g_ulBank ) + CONFIG_BANK_SIZE; ulAddress += 8 ) {
+		ulWord0 = HWREG( ulAddress );
+		ulWord1 = HWREG( ulAddress + 4 );
+
+		if ( ulWord0 == CONFIG_ERASED && ulWord1 == CONFIG_ERASED ) {
+			break;
+		}
+
+		// A torn or unknown record is skipped but its slot stays used.
+		ulKey = ulWord0 & 0xFFFF;
+		if ( ( ulWord0 >> 16 ) == ConfigCrc( ulKey, ulWord1 ) && ConfigValid( ulKey, ulWord1 ) ) {
+			g_pulConfig[ulKey] = ulWord1;
+		}
+	}
+	g_ulNextRecord = ulAddress;
+}
+
+unsigned long ConfigGet( unsigned long ulKey ) {
+	return ( ulKey < CFG_COUNT ) ? g_pulConfig[ulKey] : 0;
+}
+
+long ConfigSet( unsigned long ulKey, unsigned long ulValue ) {
+	unsigned long ulAddress;
+	unsigned long ulOld;
+
+	if ( ulKey >= CFG_COUNT ) {
+		return CONFIG_ERR_KEY;
+	}
+	if ( !ConfigValid( ulKey, ulValue ) ) {
+		return CONFIG_ERR_RANGE;
+	}
+	if ( g_pulConfig[ulKey] == ulValue ) {
+		return CONFIG_OK;
+	}
+
+	ulOld = g_pulConfig[ulKey];
+	g_pulConfig[ulKey] = ulValue;
+
+	if ( g_ulNextRecord >= BANK_BASE( g_ulBank ) + CONFIG_BANK_SIZE ) {
+		// Bank full, the compacted copy picks up the new value.
+		if ( ConfigCompact() ) {
+			g_pulConfig[ulKey] = ulOld;
+			return CONFIG_ERR_FLASH;
+		}
+		return CONFIG_OK;
+	}
+
+	// The slot is used up even if programming fails part way.
+	FlashUsecSet( SysCtlClockGet() / 1000000 );
+	ulAddress = g_ulNextRecord;
+	g_ulNextRecord += 8;
+	if ( ConfigWriteRecord( ulAddress, ulKey, ulValue ) ) {
+		g_pulConfig[ulKey] = ulOld;
+		return CONFIG_ERR_FLASH;
+	}
+
+	return CONFIG_OK;
+}
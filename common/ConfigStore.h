@@ -0,0 +1,67 @@
+//*****************************************************************************
+//
+//	ConfigStore.h
+//
+//		Persistent configuration and calibration values in on-chip flash
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Holds the values that used to be compiled in (timer
+//						load and prescale, SysCtlDelay counts, clock divisor,
+//						...) so a unit can be tuned without a rebuild.
+//
+//		Notes:			ConfigInit() must run first thing in main(), before
+//						the clock is set, since the divisor comes from here.
+//						It only reads flash; a blank region is formatted by
+//						the first ConfigSet().
+//						ConfigGet() may be called from any task or ISR.
+//						ConfigSet() writes flash, timed from SysCtlClockGet(),
+//						so it must not be called before the clock is set, and
+//						only from one task at a time.
+//
+//*****************************************************************************
+
+#ifndef __CONFIGSTORE_H__
+#define __CONFIGSTORE_H__
+
+//*****************************************************************************
+//
+//	Keys. These numbers are stored in flash; append new keys at the end and
+//	never renumber existing ones.
+//
+//*****************************************************************************
+#define CFG_PING_PERIOD			0		// mS between PING measurements
+#define CFG_STREAM				1		// 1 to print each reading on UART0
+#define CFG_SYSDIV				2		// Fastest PLL system clock divisor, 4 = 50 MHz
+#define CFG_TIMER_LOAD			3		// Timer_0_A load value
+#define CFG_TIMER_PRESCALE		4		// Timer_0_A prescale, divides by this + 1
+#define CFG_PING_SETTLE			5		// SysCtlDelay count around the PING pulse
+#define CFG_PING_PULSE			6		// SysCtlDelay count for the PING pulse width
+#define CFG_OLED_FREQUENCY		7		// SSI clock for the RIT128x96x4 in Hz
+#define CFG_GOVERNOR			8		// 1 to let Governor.c slow the clock
+#define CFG_COUNT				9
+
+//*****************************************************************************
+//
+//	ConfigSet() return values
+//
+//*****************************************************************************
+#define CONFIG_OK				0
+#define CONFIG_ERR_KEY			1		// No such key
+#define CONFIG_ERR_RANGE		2		// Value outside the key's limits
+#define CONFIG_ERR_FLASH		3		// Flash erase or program failed
+
+//*****************************************************************************
+//
+//	Turn a CFG_SYSDIV value into the matching SYSCTL_SYSDIV_n for
+//	SysCtlClockSet(). Needs inc/hw_sysctl.h.
+//
+//*****************************************************************************
+#define CONFIG_SYSCTL_SYSDIV( ulDiv ) \
+	( ( ( ( ulDiv ) - 1 ) << SYSCTL_RCC_SYSDIV_S ) | SYSCTL_RCC_USESYSDIV )
+
+extern void ConfigInit( void );
+extern unsigned long ConfigGet( unsigned long ulKey );
+extern long ConfigSet( unsigned long ulKey, unsigned long ulValue );
+
+#endif // __CONFIGSTORE_H__
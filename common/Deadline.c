@@ -0,0 +1,217 @@
+//*****************************************************************************
+//
+//	Deadline.c
+//
+//		Runtime deadline monitoring for periodic and event driven tasks
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//*****************************************************************************
+
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "Drivers/uartstdio.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "Deadline.h"
+#include "Trace.h"
+
+extern volatile int long xPortSysTickCount;
+
+static tDeadline *g_psDeadlines;
+
+//*****************************************************************************
+//
+//	Free running microseconds: whole ticks plus how far SysTick has counted
+//	down into the current tick. If SysTick has wrapped but its interrupt has
+//	not run yet (interrupts masked), the pending tick is counted here.
+//
+//*****************************************************************************
+unsigned long DeadlineMicros( void ) {
+	unsigned long ulTick;
+	unsigned long ulCurrent;
+	unsigned long ulReload;
+	unsigned long ulPending;
+
+	ulReload = HWREG( NVIC_ST_RELOAD );
+	do {
+		ulTick = xPortSysTickCount;
+		ulCurrent = HWREG( NVIC_ST_CURRENT );
+		ulPending = HWREG( NVIC_INT_CTRL ) & NVIC_INT_CTRL_PEND_SYST;
+	} while ( ulTick != xPortSysTickCount );
+
+	if ( ulPending ) {
+		ulTick++;
+		ulCurrent = HWREG( NVIC_ST_CURRENT );
+	}
+
+	// Just after a clock change the tick in progress can still be counting
+	// down from the old, longer reload.
+	if ( ulCurrent > ulReload ) {
+		ulCurrent = ulReload;
+	}
+
+	return ulTick * ( 1000000 / configTICK_RATE_HZ ) +
+		   ( ulReload - ulCurrent ) * ( 1000000 / configTICK_RATE_HZ ) / ( ulReload + 1 );
+}
+
+void DeadlineRegister( tDeadline *psDeadline, const char *pcName, unsigned long ulPeriodMs ) {
+	tDeadline *psEntry;
+
+	psDeadline->pcName = pcName;
+	psDeadline->ulPeriod = ulPeriodMs / portTICK_RATE_MS;
+	psDeadline->ulWake = xTaskGetTickCount();
+	psDeadline->ulRelease = DeadlineMicros();
+	psDeadline->bPending = 0;
+	psDeadline->ulJobs = 0;
+	psDeadline->ulLate = 0;
+	psDeadline->ulLost = 0;
+	psDeadline->ulMaxResponse = 0;
+	psDeadline->ulRecentResponse = 0;
+
+	// Tasks register after the scheduler has started, so another task or an
+	// ISR may be walking the list.
+	taskENTER_CRITICAL();
+	for ( psEntry = g_psDeadlines; psEntry && psEntry != psDeadline; psEntry = psEntry->psNext ) {
+	}
+	if ( !psEntry ) {
+		psDeadline->psNext = g_psDeadlines;
+		g_psDeadlines = psDeadline;
+	}
+	taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//	Start a job. Safe to call from an ISR, or from a task outside a critical
+//	section. A release that arrives while the previous job is still running
+//	is counted as lost; FreeRTOS would have folded it into the pending
+//	semaphore give anyway.
+//
+//*****************************************************************************
+void DeadlineRelease( tDeadline *psDeadline ) {
+	unsigned portBASE_TYPE uxSaved;
+
+	uxSaved = portSET_INTERRUPT_MASK_FROM_ISR();
+	if ( psDeadline->bPending ) {
+		psDeadline->ulLost++;
+	}
+	else {
+		psDeadline->ulRelease = DeadlineMicros();
+		psDeadline->bPending = 1;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSaved );
+}
+
+//*****************************************************************************
+//
+//	Finish the current job. bPending is taken and cleared with interrupts
+//	masked so a release from an ISR is neither lost nor counted twice.
+//
+//*****************************************************************************
+void DeadlineComplete( tDeadline *psDeadline ) {
+	unsigned long ulResponse;
+
+	taskENTER_CRITICAL();
+	if ( !psDeadline->bPending ) {
+		taskEXIT_CRITICAL();
+		return;
+	}
+	ulResponse = DeadlineMicros() - psDeadline->ulRelease;
+	psDeadline->bPending = 0;
+	taskEXIT_CRITICAL();
+
+	if ( ulResponse > psDeadline->ulMaxResponse ) {
+		psDeadline->ulMaxResponse = ulResponse;
+	}
+	if ( ulResponse > psDeadline->ulRecentResponse ) {
+		psDeadline->ulRecentResponse = ulResponse;
+	}
+	if ( psDeadline->ulPeriod && ulResponse > psDeadline->ulPeriod * portTICK_RATE_MS * 1000 ) {
+		psDeadline->ulLate++;
+		TRACE_MARK( TRACE_MARK_LATE );
+	}
+	psDeadline->ulJobs++;
+}
+
+//*****************************************************************************
+//
+//	Finish the current job of a periodic task and sleep until its next
+//	release. The release time is the nominal one, so a late wakeup shows up
+//	in the response time.
+//
+//*****************************************************************************
+void DeadlineDelayUntil( tDeadline *psDeadline ) {
+	portTickType xWake = psDeadline->ulWake;
+
+	DeadlineComplete( psDeadline );
+
+	vTaskDelayUntil( &xWake, psDeadline->ulPeriod );
+
+	taskENTER_CRITICAL();
+	psDeadline->ulWake = xWake;
+	psDeadline->ulRelease = xWake * portTICK_RATE_MS * 1000;
+	psDeadline->bPending = 1;
+	taskEXIT_CRITICAL();
+}
+
+unsigned long DeadlineMisses( void ) {
+	unsigned long ulMisses = 0;
+	tDeadline *psEntry;
+
+	for ( psEntry = g_psDeadlines; psEntry; psEntry = psEntry->psNext ) {
+		ulMisses += psEntry->ulLate + psEntry->ulLost;
+	}
+	return ulMisses;
+}
+
+//*****************************************************************************
+//
+//	Smallest ratio of deadline to recent worst response over all tasks with a
+//	deadline, in per mille (2000 means every task finished within half its
+//	period). Starts a new window for the next call. 0xFFFFFFFF if nothing
+//	has completed.
+//
+//*****************************************************************************
+unsigned long DeadlineHeadroom( void ) {
+	unsigned long ulHeadroom = 0xFFFFFFFF;
+	unsigned long ulRatio;
+	tDeadline *psEntry;
+
+	for ( psEntry = g_psDeadlines; psEntry; psEntry = psEntry->psNext ) {
+		if ( psEntry->ulPeriod && psEntry->ulRecentResponse ) {
+			// Periods up to 4 seconds fit in 32 bits here.
+			ulRatio = psEntry->ulPeriod * portTICK_RATE_MS * 1000000 / psEntry->ulRecentResponse;
+			if ( ulRatio < ulHeadroom ) {
+				ulHeadroom = ulRatio;
+			}
+		}
+		psEntry->ulRecentResponse = 0;
+	}
+	return ulHeadroom;
+}
+
+//*****************************************************************************
+//
+//	Print one line per task for tools/rmsched:
+//
+//		deadline: name period_ms max_response_us late lost jobs
+//
+//	The caller owns UART0 for the duration.
+//
+//*****************************************************************************
+void DeadlineReport( void ) {
+	tDeadline *psEntry;
+
+	for ( psEntry = g_psDeadlines; psEntry; psEntry = psEntry->psNext ) {
+		UARTprintf( "deadline: %s %u %u %u %u %u\n",
+					psEntry->pcName,
+					psEntry->ulPeriod * portTICK_RATE_MS,
+					psEntry->ulMaxResponse,
+					psEntry->ulLate,
+					psEntry->ulLost,
+					psEntry->ulJobs );
+	}
+}
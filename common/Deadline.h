@@ -0,0 +1,52 @@
+//*****************************************************************************
+//
+//	Deadline.h
+//
+//		Runtime deadline monitoring for periodic and event driven tasks
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Measure each task's response time, release to
+//						completion, and count jobs that finish after their
+//						deadline. Deadlines are implicit: a job must finish
+//						before the next release, one period later.
+//
+//		Notes:			A periodic task calls DeadlineDelayUntil() in place of
+//						vTaskDelay(). An event driven task calls
+//						DeadlineRelease() when it is woken (from the ISR if the
+//						ISR is the release) and DeadlineComplete() when done.
+//						Times come from the tick count plus the SysTick
+//						counter, in microseconds so they stay comparable when
+//						the governor changes the clock. They wrap after 2^32
+//						uS, about 71 minutes.
+//
+//*****************************************************************************
+
+#ifndef __DEADLINE_H__
+#define __DEADLINE_H__
+
+typedef struct sDeadline
+{
+	const char			*pcName;
+	unsigned long		ulPeriod;			// Ticks, 0 for no deadline
+	unsigned long		ulWake;				// Next periodic release in ticks
+	unsigned long		ulRelease;			// Time of the current release, uS
+	unsigned long		bPending;			// Released and not yet complete
+	unsigned long		ulJobs;				// Jobs completed
+	unsigned long		ulLate;				// Jobs that finished after their deadline
+	unsigned long		ulLost;				// Releases that found the last job still pending
+	unsigned long		ulMaxResponse;		// Longest release to completion, uS
+	unsigned long		ulRecentResponse;	// Longest since the last DeadlineHeadroom(), uS
+	struct sDeadline	*psNext;
+} tDeadline;
+
+extern void DeadlineRegister( tDeadline *psDeadline, const char *pcName, unsigned long ulPeriodMs );
+extern void DeadlineRelease( tDeadline *psDeadline );
+extern void DeadlineComplete( tDeadline *psDeadline );
+extern void DeadlineDelayUntil( tDeadline *psDeadline );
+extern unsigned long DeadlineMicros( void );
+extern unsigned long DeadlineMisses( void );
+extern unsigned long DeadlineHeadroom( void );
+extern void DeadlineReport( void );
+
+#endif // __DEADLINE_H__
@@ -0,0 +1,285 @@
+//*****************************************************************************
+//
+//	Display.c
+//
+//		OLED compositor: one task owns the RIT128x96x4 and draws status panes
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//*****************************************************************************
+
+#include <string.h>
+
+#include "inc/hw_types.h"
+#include "Drivers/rit128x96x4.h"
+#include "Drivers/uartstdio.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ConfigStore.h"
+#include "Deadline.h"
+#include "Display.h"
+#include "Trace.h"
+
+//*****************************************************************************
+//
+//	SSI traffic of the StellarisWare RIT128x96x4 driver: a string costs the
+//	window and address mode commands plus 8 rows of 3 bytes per 6 pixel
+//	character; an image costs the window commands plus two pixels per byte.
+//	The driver busy waits on the SSI FIFO, so at CFG_OLED_FREQUENCY every
+//	byte is 8 bit times of CPU.
+//
+//*****************************************************************************
+#define DISPLAY_SSI_STRING		10
+#define DISPLAY_SSI_CHAR		24
+#define DISPLAY_SSI_IMAGE		6
+#define DISPLAY_SSI_CLEAR		( 6 + 128 * 96 / 2 )
+
+#define DISPLAY_CHAR_WIDTH		6
+#define DISPLAY_ROW_HEIGHT		8
+#define DISPLAY_WIDTH			128
+#define DISPLAY_BAR_HEIGHT		6
+
+//*****************************************************************************
+//
+//	One slot per pane. Posting overwrites bDirty, ulValue and pcText inside a
+//	critical section; the compositor copies them out under one and draws from
+//	the copy. The shown fields belong to the compositor alone.
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned char	ucRow;
+	unsigned char	ucLevel;
+	unsigned char	bDirty;								// Posted since the last frame
+	unsigned long	ulValue;							// DISPLAY_BAR, as posted
+	unsigned long	ulShownValue;
+	char			pcText[DISPLAY_COLUMNS];			// Text panes as posted, space padded
+	char			pcShown[DISPLAY_COLUMNS];			// What the panel holds now
+} tDisplayPane;
+
+static tDisplayPane g_psPanes[DISPLAY_PANES] =
+{
+	{ 0, 8 },		// DISPLAY_TITLE
+	{ 2, 15 },		// DISPLAY_CLOCK
+	{ 4, 15 },		// DISPLAY_RANGE
+	{ 6, 15 },		// DISPLAY_BAR
+	{ 8, 8 }		// DISPLAY_STATS
+};
+
+volatile tDisplayStats g_sDisplayStats;
+
+static unsigned long g_ulFramePeriodMs;
+static tDeadline g_sDisplayDeadline;
+
+static unsigned char g_pucBar[DISPLAY_WIDTH / 2 * DISPLAY_BAR_HEIGHT];
+
+// Start of the current one second statistics window
+static portTickType g_xSecondStart;
+static unsigned long g_ulSecondBytes;
+static unsigned long g_ulBusyMicros;
+
+//*****************************************************************************
+//
+//	Posting. Runs in the caller's task and never blocks. The update replaces
+//	whatever the pane's slot holds, so the newest one is always drawn.
+//
+//*****************************************************************************
+static void DisplayPost( unsigned long ulPane, unsigned long ulValue, const char *pcText ) {
+	tDisplayPane *psPane = &g_psPanes[ulPane];
+
+	taskENTER_CRITICAL();
+	if ( psPane->bDirty ) {
+		g_sDisplayStats.ulCoalesced++;
+	}
+	psPane->bDirty = 1;
+	psPane->ulValue = ulValue;
+	if ( pcText ) {
+		memcpy( psPane->pcText, pcText, DISPLAY_COLUMNS );
+	}
+	g_sDisplayStats.ulMessages++;
+	taskEXIT_CRITICAL();
+}
+
+void DisplayText( unsigned long ulPane, const char *pcText ) {
+	char pcPadded[DISPLAY_COLUMNS];
+	unsigned long ulIdx;
+
+	if ( ulPane >= DISPLAY_PANES || ulPane == DISPLAY_BAR ) {
+		return;
+	}
+
+	for ( ulIdx = 0; ulIdx < DISPLAY_COLUMNS && pcText[ulIdx] && pcText[ulIdx] != '\n'; ulIdx++ ) {
+		pcPadded[ulIdx] = pcText[ulIdx];
+	}
+	memset( &pcPadded[ulIdx], ' ', DISPLAY_COLUMNS - ulIdx );
+	DisplayPost( ulPane, 0, pcPadded );
+}
+
+void DisplayBar( unsigned long ulValue ) {
+	DisplayPost( DISPLAY_BAR, ulValue > DISPLAY_BAR_MAX ? DISPLAY_BAR_MAX : ulValue, NULL );
+}
+
+//*****************************************************************************
+//
+//	Drawing. Only the compositor gets here.
+//
+//*****************************************************************************
+static void DisplayDrawText( tDisplayPane *psPane, const char *pcText ) {
+	char pcSpan[DISPLAY_COLUMNS + 1];
+	unsigned long ulFirst, ulLast;
+
+	// Redraw from the first to the last character that changed.
+	for ( ulFirst = 0; ulFirst < DISPLAY_COLUMNS && pcText[ulFirst] == psPane->pcShown[ulFirst]; ulFirst++ ) {
+	}
+	if ( ulFirst == DISPLAY_COLUMNS ) {
+		return;
+	}
+	for ( ulLast = DISPLAY_COLUMNS - 1; pcText[ulLast] == psPane->pcShown[ulLast]; ulLast-- ) {
+	}
+
+	memcpy( pcSpan, &pcText[ulFirst], ulLast - ulFirst + 1 );
+	pcSpan[ulLast - ulFirst + 1] = 0;
+	TRACE_BEGIN( TRACE_SPAN_DRAW );
+	RIT128x96x4StringDraw( pcSpan, ulFirst * DISPLAY_CHAR_WIDTH, psPane->ucRow * DISPLAY_ROW_HEIGHT, psPane->ucLevel );
+	TRACE_END( TRACE_SPAN_DRAW );
+	memcpy( psPane->pcShown, pcText, DISPLAY_COLUMNS );
+
+	g_sDisplayStats.ulSsiBytes += DISPLAY_SSI_STRING + ( ulLast - ulFirst + 1 ) * DISPLAY_SSI_CHAR;
+}
+
+static void DisplayDrawBar( tDisplayPane *psPane, unsigned long ulValue ) {
+	unsigned long ulFill, ulShown, ulLeft, ulRight, ulX, ulRow;
+	unsigned char *pucPixel;
+
+	ulFill = ulValue * DISPLAY_WIDTH / DISPLAY_BAR_MAX;
+	ulShown = psPane->ulShownValue * DISPLAY_WIDTH / DISPLAY_BAR_MAX;
+	if ( ulFill == ulShown ) {
+		return;
+	}
+
+	// Only the columns between the old and new ends, on a byte boundary.
+	ulLeft = ( ulFill < ulShown ? ulFill : ulShown ) & ~1;
+	ulRight = ( ( ulFill > ulShown ? ulFill : ulShown ) + 1 ) & ~1;
+
+	pucPixel = g_pucBar;
+	for ( ulRow = 0; ulRow < DISPLAY_BAR_HEIGHT; ulRow++ ) {
+		for ( ulX = ulLeft; ulX < ulRight; ulX += 2 ) {
+			*pucPixel++ = ( ulX < ulFill ? psPane->ucLevel << 4 : 0 ) | ( ulX + 1 < ulFill ? psPane->ucLevel : 0 );
+		}
+	}
+	TRACE_BEGIN( TRACE_SPAN_DRAW );
+	RIT128x96x4ImageDraw( g_pucBar, ulLeft, psPane->ucRow * DISPLAY_ROW_HEIGHT + 1,
+						  ulRight - ulLeft, DISPLAY_BAR_HEIGHT );
+	TRACE_END( TRACE_SPAN_DRAW );
+	psPane->ulShownValue = ulValue;
+
+	g_sDisplayStats.ulSsiBytes += DISPLAY_SSI_IMAGE + ( ulRight - ulLeft ) / 2 * DISPLAY_BAR_HEIGHT;
+}
+
+//*****************************************************************************
+//
+//	One frame: copy out each pane posted since the last frame and draw what
+//	changed. Only the copy is under the critical section, not the SSI
+//	traffic. Called by the Display task once per frame period, or directly
+//	by a host harness.
+//
+//*****************************************************************************
+void DisplayFrame( void ) {
+	char pcText[DISPLAY_COLUMNS];
+	tDisplayPane *psPane;
+	unsigned long ulStart, ulBytes, ulPane, ulValue, ulElapsedMs;
+	unsigned char bDirty;
+	portTickType xNow;
+
+	ulStart = DeadlineMicros();
+	ulBytes = g_sDisplayStats.ulSsiBytes;
+
+	for ( ulPane = 0; ulPane < DISPLAY_PANES; ulPane++ ) {
+		psPane = &g_psPanes[ulPane];
+
+		taskENTER_CRITICAL();
+		bDirty = psPane->bDirty;
+		if ( bDirty ) {
+			ulValue = psPane->ulValue;
+			memcpy( pcText, psPane->pcText, DISPLAY_COLUMNS );
+			psPane->bDirty = 0;
+		}
+		taskEXIT_CRITICAL();
+
+		if ( !bDirty ) {
+			continue;
+		}
+		if ( ulPane == DISPLAY_BAR ) {
+			DisplayDrawBar( psPane, ulValue );
+		}
+		else {
+			DisplayDrawText( psPane, pcText );
+		}
+	}
+
+	if ( g_sDisplayStats.ulSsiBytes != ulBytes ) {
+		g_sDisplayStats.ulFrames++;
+	}
+	g_ulBusyMicros += DeadlineMicros() - ulStart;
+
+	xNow = xTaskGetTickCount();
+	ulElapsedMs = ( xNow - g_xSecondStart ) * portTICK_RATE_MS;
+	if ( ulElapsedMs >= 1000 ) {
+		g_sDisplayStats.ulSsiRate = ( g_sDisplayStats.ulSsiBytes - g_ulSecondBytes ) * 1000 / ulElapsedMs;
+		g_sDisplayStats.ulCpuPermille = g_ulBusyMicros / ulElapsedMs;
+		g_xSecondStart = xNow;
+		g_ulSecondBytes = g_sDisplayStats.ulSsiBytes;
+		g_ulBusyMicros = 0;
+	}
+}
+
+static void Display( void *pvParameters ) {
+
+	DeadlineRegister( &g_sDisplayDeadline, "Display", g_ulFramePeriodMs );
+
+	while ( 1 ) {
+		DisplayFrame();
+		DeadlineDelayUntil( &g_sDisplayDeadline );
+	}
+}
+
+//*****************************************************************************
+//
+//	Takes over the panel and starts the compositor. Call from main() before
+//	the scheduler starts.
+//
+//*****************************************************************************
+void DisplayInit( unsigned long ulPriority, unsigned long ulFramePeriodMs ) {
+	unsigned long ulPane;
+
+	RIT128x96x4Init( ConfigGet( CFG_OLED_FREQUENCY ) );
+	RIT128x96x4Clear();
+	g_sDisplayStats.ulSsiBytes += DISPLAY_SSI_CLEAR;
+
+	for ( ulPane = 0; ulPane < DISPLAY_PANES; ulPane++ ) {
+		memset( g_psPanes[ulPane].pcText, ' ', DISPLAY_COLUMNS );
+		memset( g_psPanes[ulPane].pcShown, ' ', DISPLAY_COLUMNS );
+	}
+
+	g_ulFramePeriodMs = ulFramePeriodMs;
+	g_xSecondStart = xTaskGetTickCount();
+
+	xTaskCreate( Display, ( signed portCHAR * ) "Display", 256, NULL, ulPriority, NULL );
+}
+
+//*****************************************************************************
+//
+//	One line for the serial log. The caller owns UART0 for the duration.
+//
+//*****************************************************************************
+void DisplayReport( void ) {
+	UARTprintf( "display: frames %u messages %u coalesced %u ssi_bytes %u ssi_rate %u cpu_permille %u\n",
+				g_sDisplayStats.ulFrames,
+				g_sDisplayStats.ulMessages,
+				g_sDisplayStats.ulCoalesced,
+				g_sDisplayStats.ulSsiBytes,
+				g_sDisplayStats.ulSsiRate,
+				g_sDisplayStats.ulCpuPermille );
+}
@@ -0,0 +1,62 @@
+//*****************************************************************************
+//
+//	Display.h
+//
+//		OLED compositor: one task owns the RIT128x96x4 and draws status panes
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Tasks post pane updates instead of drawing. The
+//						compositor wakes once per frame, keeps the last update
+//						for each pane, and sends only the characters that
+//						changed since the previous frame. A task that updates
+//						faster than the frame rate costs a 21 byte copy, not
+//						SSI traffic.
+//
+//		Notes:			Nothing else may call the RIT128x96x4 driver once
+//						DisplayInit() has run. The posting calls never block and
+//						never lose an update: each pane has one slot, the newest
+//						update overwrites it in a short critical section, and
+//						the next frame draws what the slot holds.
+//						Panes are one 21 character row each:
+//
+//							row 0	DISPLAY_TITLE
+//							row 2	DISPLAY_CLOCK
+//							row 4	DISPLAY_RANGE
+//							row 6	DISPLAY_BAR		(bar graph)
+//							row 8	DISPLAY_STATS
+//
+//*****************************************************************************
+
+#ifndef __DISPLAY_H__
+#define __DISPLAY_H__
+
+#define DISPLAY_TITLE			0
+#define DISPLAY_CLOCK			1
+#define DISPLAY_RANGE			2
+#define DISPLAY_BAR				3
+#define DISPLAY_STATS			4
+#define DISPLAY_PANES			5
+
+#define DISPLAY_COLUMNS			21		// 128 pixel columns / 6
+#define DISPLAY_BAR_MAX			100		// DisplayBar() value for a full bar
+
+typedef struct
+{
+	unsigned long	ulFrames;			// Frames that drew something
+	unsigned long	ulMessages;			// Pane updates received
+	unsigned long	ulCoalesced;		// Updates replaced before they were drawn
+	unsigned long	ulSsiBytes;			// Bytes sent to the panel, estimated
+	unsigned long	ulSsiRate;			// Bytes per second over the last second
+	unsigned long	ulCpuPermille;		// Compositor CPU load over the last second
+} tDisplayStats;
+
+extern volatile tDisplayStats g_sDisplayStats;
+
+extern void DisplayInit( unsigned long ulPriority, unsigned long ulFramePeriodMs );
+extern void DisplayText( unsigned long ulPane, const char *pcText );
+extern void DisplayBar( unsigned long ulValue );
+extern void DisplayFrame( void );
+extern void DisplayReport( void );
+
+#endif // __DISPLAY_H__
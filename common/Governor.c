@@ -0,0 +1,325 @@
+//*****************************************************************************
+//
+//	Governor.c
+//
+//		Clock scaling: slow the system clock when the load allows it
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//*****************************************************************************
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/ssi.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/uart.h"
+#include "Drivers/uartstdio.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ConfigStore.h"
+#include "Deadline.h"
+#include "Governor.h"
+#include "Trace.h"
+
+tGovernorState g_sGovernor;
+
+static unsigned long g_ulRefDiv;			// CFG_SYSDIV, what the calibration is for
+static unsigned long g_ulRefPrescale;		// CFG_TIMER_PRESCALE + 1
+static unsigned long g_ulPeriodMs;
+static unsigned long g_ulIdleMicros;		// Added to by GovernorIdle()
+static tDeadline g_sGovernorDeadline;
+
+//*****************************************************************************
+//
+//	The OLED bit rate SSIConfigSetExpClk() sets from ulClock: the smallest
+//	even prescale whose serial clock rate divisor fits in 8 bits. The
+//	divisors truncate, so the rate can come out above CFG_OLED_FREQUENCY.
+//	ulClock must be at least twice CFG_OLED_FREQUENCY.
+//
+//*****************************************************************************
+static unsigned long GovernorSsiRate( unsigned long ulClock ) {
+	unsigned long ulMaxBitRate = ulClock / ConfigGet( CFG_OLED_FREQUENCY );
+	unsigned long ulPreDiv = 0;
+	unsigned long ulScr;
+
+	do {
+		ulPreDiv += 2;
+		ulScr = ulMaxBitRate / ulPreDiv - 1;
+	} while ( ulScr > 255 );
+
+	return ulClock / ( ulPreDiv * ( ulScr + 1 ) );
+}
+
+//*****************************************************************************
+//
+//	A divisor is usable when the Timer_0_A prescale that keeps the count rate
+//	of the reference clock is a whole number, SysTick still divides into
+//	whole ticks, and SSI0 does not drive the OLED faster than
+//	CFG_OLED_FREQUENCY. The reference clock may itself round the OLED rate
+//	up (4.17 MHz at 50 MHz for 4 MHz); what it runs at is allowed too.
+//
+//*****************************************************************************
+static tBoolean GovernorUsable( unsigned long ulSysDiv ) {
+	unsigned long ulClock = GOVERNOR_PLL_HZ / ulSysDiv;
+	unsigned long ulRefClock = GOVERNOR_PLL_HZ / g_ulRefDiv;
+	unsigned long ulSsiMax = ConfigGet( CFG_OLED_FREQUENCY );
+
+	if ( ulRefClock >= 2 * ulSsiMax && GovernorSsiRate( ulRefClock ) > ulSsiMax ) {
+		ulSsiMax = GovernorSsiRate( ulRefClock );
+	}
+
+	return ( g_ulRefPrescale * g_ulRefDiv % ulSysDiv == 0 &&
+			 GOVERNOR_PLL_HZ % ulSysDiv == 0 &&
+			 ulClock % configTICK_RATE_HZ == 0 &&
+			 ulClock >= 2 * ConfigGet( CFG_OLED_FREQUENCY ) &&
+			 GovernorSsiRate( ulClock ) <= ulSsiMax );
+}
+
+static tBoolean GovernorPeripheralOn( unsigned long ulRcgc1 ) {
+	return ( HWREG( SYSCTL_RCGC1 ) & ulRcgc1 ) != 0;
+}
+
+//*****************************************************************************
+//
+//	Timer_0_A prescale for the current clock. Tasks that program Timer_0_A
+//	use this rather than CFG_TIMER_PRESCALE.
+//
+//*****************************************************************************
+unsigned long GovernorTimerPrescale( void ) {
+	return g_ulRefPrescale * g_ulRefDiv / g_sGovernor.ulSysDiv - 1;
+}
+
+//*****************************************************************************
+//
+//	Scale a cycle count calibrated at the reference clock, such as a
+//	SysCtlDelay() count, to the current clock. Rounds up so a delay is never
+//	shorter than calibrated.
+//
+//*****************************************************************************
+unsigned long GovernorScale( unsigned long ulCount ) {
+	return ( ulCount * g_ulRefDiv + g_sGovernor.ulSysDiv - 1 ) / g_sGovernor.ulSysDiv;
+}
+
+//
+// True while UART0 or the OLED is still sending at the current rate.
+//
+static tBoolean GovernorBusy( void ) {
+	return ( ( GovernorPeripheralOn( SYSCTL_RCGC1_UART0 ) && UARTBusy( UART0_BASE ) ) ||
+			 ( GovernorPeripheralOn( SYSCTL_RCGC1_SSI0 ) && SSIBusy( SSI0_BASE ) ) );
+}
+
+//*****************************************************************************
+//
+//	Switch to ulSysDiv and re-derive everything that counts system clocks.
+//	Peripherals that are not enabled yet are skipped; they pick up the new
+//	clock when their owner sets them up.
+//
+//*****************************************************************************
+unsigned long GovernorClockSet( unsigned long ulSysDiv ) {
+	unsigned long ulClock;
+	unsigned long ulIdx;
+	tBoolean bMasked;
+
+	for ( ulIdx = 0; ulIdx < g_sGovernor.ulDivisors && g_sGovernor.pulDivisor[ulIdx] != ulSysDiv; ulIdx++ ) {
+	}
+	if ( ulIdx == g_sGovernor.ulDivisors ) {
+		return GOVERNOR_ERR_DIVISOR;
+	}
+	if ( ulSysDiv == g_sGovernor.ulSysDiv ) {
+		return GOVERNOR_OK;
+	}
+
+	// Let UART0 and the OLED finish what they are sending at the old rate.
+	// With the scheduler suspended no task can start another byte, but an
+	// interrupt could between the drain and the mask, so look again once
+	// masked.
+	vTaskSuspendAll();
+	while ( 1 ) {
+		while ( GovernorBusy() ) {
+		}
+		bMasked = IntMasterDisable();
+		if ( !GovernorBusy() ) {
+			break;
+		}
+		if ( !bMasked ) {
+			IntMasterEnable();
+		}
+	}
+
+	// The PLL is already locked, so only the divisor changes. SysCtlClockSet()
+	// would bypass the PLL and wait for it to relock with interrupts masked.
+	HWREG( SYSCTL_RCC ) = ( HWREG( SYSCTL_RCC ) & ~SYSCTL_RCC_SYSDIV_M ) | CONFIG_SYSCTL_SYSDIV( ulSysDiv );
+	ulClock = SysCtlClockGet();
+	g_sGovernor.ulSysDiv = ulSysDiv;
+	g_sGovernor.ulSwitches++;
+
+	// Takes effect at the next tick; the tick in progress runs out at the new
+	// clock. The trace keeps the old reload to scale the events before it.
+	TRACE_CLOCK( HWREG( NVIC_ST_RELOAD ) );
+	HWREG( NVIC_ST_RELOAD ) = ulClock / configTICK_RATE_HZ - 1;
+
+	if ( GovernorPeripheralOn( SYSCTL_RCGC1_TIMER0 ) ) {
+		TimerPrescaleSet( TIMER0_BASE, TIMER_A, GovernorTimerPrescale() );
+	}
+	if ( GovernorPeripheralOn( SYSCTL_RCGC1_UART0 ) ) {
+		UARTConfigSetExpClk( UART0_BASE, ulClock, 115200,
+							 UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE );
+	}
+	if ( GovernorPeripheralOn( SYSCTL_RCGC1_SSI0 ) ) {
+		SSIDisable( SSI0_BASE );
+		SSIConfigSetExpClk( SSI0_BASE, ulClock, SSI_FRF_MOTO_MODE_2, SSI_MODE_MASTER,
+							ConfigGet( CFG_OLED_FREQUENCY ), 8 );
+		SSIEnable( SSI0_BASE );
+	}
+
+	if ( !bMasked ) {
+		IntMasterEnable();
+	}
+	xTaskResumeAll();
+	return GOVERNOR_OK;
+}
+
+//*****************************************************************************
+//
+//	Called from vApplicationIdleHook(). Sleeps until the next interrupt and
+//	counts the time asleep as idle. Interrupts stay masked across the sleep
+//	so the handler, and any task it wakes, run after the time is taken.
+//
+//	vTaskStartScheduler() loads SysTick from configCPU_CLOCK_HZ, which is
+//	only right if that matches the CFG_SYSDIV the lab booted at. The first
+//	time the CPU goes idle after that, the reload is set for the clock
+//	actually running; a switch cannot be half done while idle runs.
+//
+//*****************************************************************************
+void GovernorIdle( void ) {
+	unsigned long ulStart;
+	unsigned long ulReload;
+
+	IntMasterDisable();
+	ulReload = GOVERNOR_PLL_HZ / g_sGovernor.ulSysDiv / configTICK_RATE_HZ - 1;
+	if ( HWREG( NVIC_ST_RELOAD ) != ulReload ) {
+		HWREG( NVIC_ST_RELOAD ) = ulReload;
+	}
+	ulStart = DeadlineMicros();
+	SysCtlSleep();
+	g_ulIdleMicros += DeadlineMicros() - ulStart;
+	IntMasterEnable();
+}
+
+//*****************************************************************************
+//
+//	One decision per period. Work and response times are assumed to scale
+//	with the clock period, which overestimates tasks that wait on hardware.
+//
+//*****************************************************************************
+static void GovernorUpdate( unsigned long ulMisses, unsigned long *pulHold ) {
+	unsigned long ulIdx, ulNext;
+
+	for ( ulIdx = 0; g_sGovernor.pulDivisor[ulIdx] != g_sGovernor.ulSysDiv; ulIdx++ ) {
+	}
+
+	if ( ulMisses ) {
+		*pulHold = GOVERNOR_HOLD;
+		GovernorClockSet( g_sGovernor.pulDivisor[0] );
+		return;
+	}
+	if ( *pulHold ) {
+		( *pulHold )--;
+		return;
+	}
+
+	if ( ulIdx > 0 && ( g_sGovernor.ulLoad > GOVERNOR_LOAD_HIGH || g_sGovernor.ulHeadroom < GOVERNOR_HEADROOM_MIN ) ) {
+		GovernorClockSet( g_sGovernor.pulDivisor[ulIdx - 1] );
+	}
+	else if ( ulIdx + 1 < g_sGovernor.ulDivisors ) {
+		ulNext = g_sGovernor.pulDivisor[ulIdx + 1];
+		if ( g_sGovernor.ulLoad * ulNext / g_sGovernor.ulSysDiv <= GOVERNOR_LOAD_TARGET &&
+			 ( g_sGovernor.ulHeadroom == 0xFFFFFFFF ||
+			   g_sGovernor.ulHeadroom * g_sGovernor.ulSysDiv / ulNext >= GOVERNOR_HEADROOM_MIN ) ) {
+			GovernorClockSet( ulNext );
+		}
+	}
+}
+
+static void Governor( void *pvParameters ) {
+	unsigned long ulStart, ulElapsedMs, ulIdleMs, ulLastMisses;
+	unsigned long ulHold = 0;
+
+	DeadlineRegister( &g_sGovernorDeadline, "Governor", g_ulPeriodMs );
+
+	ulStart = DeadlineMicros();
+	ulLastMisses = DeadlineMisses();
+
+	while ( 1 ) {
+		DeadlineDelayUntil( &g_sGovernorDeadline );
+
+		// The idle task cannot run while this one is ready, so the idle count
+		// cannot change under us.
+		ulElapsedMs = ( DeadlineMicros() - ulStart ) / 1000 + 1;
+		ulIdleMs = g_ulIdleMicros / 1000;
+		g_sGovernor.ulLoad = ulIdleMs >= ulElapsedMs ? 0 : 1000 - ulIdleMs * 1000 / ulElapsedMs;
+		g_sGovernor.ulHeadroom = DeadlineHeadroom();
+
+		// CFG_GOVERNOR can be cleared over the command link at any time.
+		if ( ConfigGet( CFG_GOVERNOR ) ) {
+			GovernorUpdate( DeadlineMisses() - ulLastMisses, &ulHold );
+		}
+		else {
+			GovernorClockSet( g_sGovernor.pulDivisor[0] );
+		}
+
+		g_ulIdleMicros = 0;
+		ulStart = DeadlineMicros();
+		ulLastMisses = DeadlineMisses();
+	}
+}
+
+//*****************************************************************************
+//
+//	Call from main() after ConfigInit() and SysCtlClockSet() at CFG_SYSDIV.
+//	Builds the table of usable divisors up to ulSysDivMax, the slowest clock
+//	the lab's TaskSet.h analysis covers; starts the governor task only if
+//	there is a slower divisor to use. The task reads CFG_GOVERNOR each
+//	period.
+//
+//*****************************************************************************
+void GovernorInit( unsigned long ulPriority, unsigned long ulPeriodMs, unsigned long ulSysDivMax ) {
+	unsigned long ulSysDiv;
+
+	g_ulRefDiv = ConfigGet( CFG_SYSDIV );
+	g_ulRefPrescale = ConfigGet( CFG_TIMER_PRESCALE ) + 1;
+	g_ulPeriodMs = ulPeriodMs;
+	g_sGovernor.ulSysDiv = g_ulRefDiv;
+	g_sGovernor.ulDivisors = 0;
+	if ( ulSysDivMax > GOVERNOR_SYSDIV_MAX ) {
+		ulSysDivMax = GOVERNOR_SYSDIV_MAX;
+	}
+	for ( ulSysDiv = g_ulRefDiv; ulSysDiv <= ulSysDivMax; ulSysDiv++ ) {
+		if ( GovernorUsable( ulSysDiv ) ) {
+			g_sGovernor.pulDivisor[g_sGovernor.ulDivisors++] = ulSysDiv;
+		}
+	}
+
+	if ( g_sGovernor.ulDivisors > 1 && g_sGovernor.pulDivisor[0] == g_ulRefDiv ) {
+		xTaskCreate( Governor, ( signed portCHAR * ) "Governor", 128, NULL, ulPriority, NULL );
+	}
+}
+
+//*****************************************************************************
+//
+//	One line for the serial log. The caller owns UART0 for the duration.
+//
+//*****************************************************************************
+void GovernorReport( void ) {
+	UARTprintf( "governor: sysdiv %u clock %u load_permille %u switches %u\n",
+				g_sGovernor.ulSysDiv,
+				GOVERNOR_PLL_HZ / g_sGovernor.ulSysDiv,
+				g_sGovernor.ulLoad,
+				g_sGovernor.ulSwitches );
+}
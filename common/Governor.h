@@ -0,0 +1,79 @@
+//*****************************************************************************
+//
+//	Governor.h
+//
+//		Clock scaling: slow the system clock when the load allows it
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Measure CPU load from the idle task and deadline
+//						headroom from Deadline.c, and run at the slowest PLL
+//						divisor that keeps both within limits. Any missed
+//						deadline goes straight back to full speed.
+//
+//		Notes:			CFG_SYSDIV is the fastest clock, the one the labs boot
+//						at; CFG_TIMER_PRESCALE, CFG_PING_SETTLE and
+//						CFG_PING_PULSE are calibrated for it. Only divisors
+//						that keep the Timer_0_A count rate and the SysTick
+//						period exact are used, so timer readings and periods
+//						mean the same at every clock. On a change the governor
+//						re-derives SysTick, the Timer_0_A prescale, the UART0
+//						baud divisor and the SSI0 (OLED) bit rate. Delay loops
+//						scale their counts with GovernorScale(). The table is
+//						built at boot, so new CFG_SYSDIV, CFG_TIMER_PRESCALE or
+//						CFG_OLED_FREQUENCY values need a reset. CFG_GOVERNOR is
+//						read every period; clearing it returns to CFG_SYSDIV
+//						within one governor period. Divisors above the
+//						TASKSET_SYSDIV_MAX the lab passes in are never used,
+//						since its WCETs only hold down to that clock.
+//
+//						The lab must call GovernorIdle() from
+//						vApplicationIdleHook() (configUSE_IDLE_HOOK 1). A
+//						switch can stretch or shrink the SysTick period in
+//						progress; the Timer_0_A period is unaffected. The
+//						first GovernorIdle() also corrects the SysTick reload
+//						the scheduler set from configCPU_CLOCK_HZ, if that
+//						does not match the CFG_SYSDIV the lab booted at.
+//
+//*****************************************************************************
+
+#ifndef __GOVERNOR_H__
+#define __GOVERNOR_H__
+
+#define GOVERNOR_PLL_HZ			200000000	// 400 MHz PLL / 2, before SYSDIV
+#define GOVERNOR_SYSDIV_MAX		16
+#define GOVERNOR_DIVISORS		( GOVERNOR_SYSDIV_MAX - 3 )
+
+#define GOVERNOR_LOAD_TARGET	600			// Per mille; slow down only if the load stays below
+#define GOVERNOR_LOAD_HIGH		850			// Per mille; speed up above
+#define GOVERNOR_HEADROOM_MIN	1333		// Deadline / response, per mille; 75% of the period
+#define GOVERNOR_HOLD			4			// Periods at full speed after a missed deadline
+
+//*****************************************************************************
+//
+//	GovernorClockSet() return values
+//
+//*****************************************************************************
+#define GOVERNOR_OK				0
+#define GOVERNOR_ERR_DIVISOR	1			// Not in pulDivisor; timing would drift
+
+typedef struct
+{
+	unsigned long	ulSysDiv;						// Current divisor
+	unsigned long	ulLoad;							// CPU load over the last period, per mille
+	unsigned long	ulHeadroom;						// DeadlineHeadroom() over the last period
+	unsigned long	ulSwitches;						// Clock changes
+	unsigned long	ulDivisors;						// Entries in pulDivisor
+	unsigned long	pulDivisor[GOVERNOR_DIVISORS];	// Usable divisors, fastest first
+} tGovernorState;
+
+extern tGovernorState g_sGovernor;
+
+extern void GovernorInit( unsigned long ulPriority, unsigned long ulPeriodMs, unsigned long ulSysDivMax );
+extern void GovernorIdle( void );
+extern unsigned long GovernorClockSet( unsigned long ulSysDiv );
+extern unsigned long GovernorTimerPrescale( void );
+extern unsigned long GovernorScale( unsigned long ulCount );
+extern void GovernorReport( void );
+
+#endif // __GOVERNOR_H__
@@ -0,0 +1,167 @@
+//*****************************************************************************
+//
+//	Trace.c
+//
+//		Timeline trace of task switches, interrupts and code spans
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Notes:			Empty unless TRACE_ENABLE is defined, so the ring
+//						buffer costs no RAM in a normal build.
+//
+//*****************************************************************************
+
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "Drivers/uartstdio.h"
+
+#include "FreeRTOS.h"
+
+#include "Trace.h"
+
+#ifdef TRACE_ENABLE
+
+tTraceEvent g_psTrace[TRACE_EVENTS];
+volatile unsigned long g_ulTraceHead;
+volatile unsigned long g_bTraceActive = 1;
+
+static const char * const g_ppcTraceIsrs[TRACE_ISRS] =
+{
+	"Timer_0_A",			// TRACE_ISR_TIMER_0_A
+	"UART0"					// TRACE_ISR_UART0
+};
+
+static const char * const g_ppcTraceUser[TRACE_USER] =
+{
+	"ping",					// TRACE_SPAN_PING
+	"echo wait",			// TRACE_SPAN_ECHO
+	"oled draw",			// TRACE_SPAN_DRAW
+	"semaphore take",		// TRACE_SPAN_TAKE
+	"semaphore give",		// TRACE_MARK_GIVE
+	"deadline late"			// TRACE_MARK_LATE
+};
+
+//*****************************************************************************
+//
+//	The SysTick reload in force after event ulIdx: the reload the next
+//	TRACE_EVENT_CLOCK found, or the one set now if the clock has not changed
+//	since.
+//
+//*****************************************************************************
+static unsigned long TraceReloadAfter( unsigned long ulIdx, unsigned long ulHead ) {
+	tTraceEvent *psEvent;
+
+	for ( ulIdx++; ulIdx != ulHead; ulIdx++ ) {
+		psEvent = &g_psTrace[ulIdx & ( TRACE_EVENTS - 1 )];
+		if ( psEvent->ulStamp >> TRACE_STAMP_TYPE_S == TRACE_EVENT_CLOCK ) {
+			return psEvent->ulArg;
+		}
+	}
+	return HWREG( NVIC_ST_RELOAD );
+}
+
+//*****************************************************************************
+//
+//	Throw away what has been recorded and carry on recording.
+//
+//*****************************************************************************
+void TraceStart( void ) {
+	g_bTraceActive = 0;
+	g_ulTraceHead = 0;
+	g_bTraceActive = 1;
+}
+
+//*****************************************************************************
+//
+//	Pause recording, print the names and then the events oldest first, one
+//	"trace:" line each, and start again with an empty buffer. The caller
+//	owns UART0 for the duration.
+//
+//		trace: begin <events> <overwritten> <tick rate Hz>
+//		trace: task <name pointer> <name>			(pointer in hex)
+//		trace: isr|span <id> <name>
+//		trace: <uS> <type> <arg>					(arg in hex)
+//		trace: end
+//
+//	uS count from tick 0 and wrap at 32 bits. The SysTick count is scaled by
+//	the reload in force: a new reload loads when the tick after the
+//	governor's TRACE_EVENT_CLOCK starts, whose arg is the reload before it.
+//	A clock event's arg is printed as the new clock in Hz instead. The scale
+//	is exact for reloads below 2^32 / 1000, which every clock the governor
+//	picks is.
+//
+//*****************************************************************************
+void TraceDump( void ) {
+	static unsigned long pulNames[TRACE_NAMES];
+	unsigned long ulHead, ulFirst, ulIdx, ulSeen, ulNames;
+	unsigned long ulReload, ulNextReload, ulClockTick;
+	unsigned long ulTick, ulCurrent, ulType, ulArg;
+	tTraceEvent *psEvent;
+
+	g_bTraceActive = 0;
+	ulHead = g_ulTraceHead;
+	ulFirst = ulHead > TRACE_EVENTS ? ulHead - TRACE_EVENTS : 0;
+
+	UARTprintf( "trace: begin %u %u %u\n", ulHead - ulFirst, ulFirst, configTICK_RATE_HZ );
+
+	// Each task once, at its first switch in the ring. The names printed so
+	// far are kept in pulNames, so this is one pass over the ring.
+	ulNames = 0;
+	for ( ulIdx = ulFirst; ulIdx != ulHead; ulIdx++ ) {
+		psEvent = &g_psTrace[ulIdx & ( TRACE_EVENTS - 1 )];
+		if ( psEvent->ulStamp >> TRACE_STAMP_TYPE_S != TRACE_EVENT_TASK ) {
+			continue;
+		}
+		for ( ulSeen = 0; ulSeen < ulNames && pulNames[ulSeen] != psEvent->ulArg; ulSeen++ ) {
+		}
+		if ( ulSeen == ulNames ) {
+			UARTprintf( "trace: task %08x %s\n", psEvent->ulArg, ( const char * )psEvent->ulArg );
+			if ( ulNames < TRACE_NAMES ) {
+				pulNames[ulNames++] = psEvent->ulArg;
+			}
+		}
+	}
+	for ( ulIdx = 0; ulIdx < TRACE_ISRS; ulIdx++ ) {
+		UARTprintf( "trace: isr %u %s\n", ulIdx, g_ppcTraceIsrs[ulIdx] );
+	}
+	for ( ulIdx = 0; ulIdx < TRACE_USER; ulIdx++ ) {
+		UARTprintf( "trace: span %u %s\n", ulIdx, g_ppcTraceUser[ulIdx] );
+	}
+
+	ulReload = TraceReloadAfter( ulFirst - 1, ulHead );
+	ulNextReload = ulReload;
+	ulClockTick = 0;
+	for ( ulIdx = ulFirst; ulIdx != ulHead; ulIdx++ ) {
+		psEvent = &g_psTrace[ulIdx & ( TRACE_EVENTS - 1 )];
+		ulType = psEvent->ulStamp >> TRACE_STAMP_TYPE_S;
+		ulCurrent = psEvent->ulStamp & TRACE_STAMP_CURRENT;
+		ulTick = psEvent->ulTick;
+
+		// A wrap the SysTick interrupt has not counted yet.
+		if ( ( psEvent->ulStamp & TRACE_STAMP_PENDING ) || ulCurrent + 8 > ulReload ) {
+			ulTick++;
+		}
+		if ( ulNextReload != ulReload && (long)( ulTick - ulClockTick ) > 0 ) {
+			ulReload = ulNextReload;
+		}
+		if ( ulCurrent > ulReload ) {
+			ulCurrent = ulReload;
+		}
+
+		ulArg = psEvent->ulArg;
+		if ( ulType == TRACE_EVENT_CLOCK ) {
+			ulNextReload = TraceReloadAfter( ulIdx, ulHead );
+			ulClockTick = ulTick;
+			ulArg = ( ulNextReload + 1 ) * configTICK_RATE_HZ;
+		}
+		UARTprintf( "trace: %u %u %x\n",
+					ulTick * ( 1000000 / configTICK_RATE_HZ ) +
+					( ulReload - ulCurrent ) * ( 1000000 / configTICK_RATE_HZ ) / ( ulReload + 1 ),
+					ulType, ulArg );
+	}
+	UARTprintf( "trace: end\n" );
+
+	TraceStart();
+}
+
+#endif // TRACE_ENABLE
@@ -0,0 +1,156 @@
+//*****************************************************************************
+//
+//	Trace.h
+//
+//		Timeline trace of task switches, interrupts and code spans
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Record when tasks run, when ISRs enter and exit, and
+//						when marked pieces of code start and end, into a RAM
+//						ring buffer. TraceDump() prints it on UART0 as
+//						"trace:" lines. tools/trace2json turns those into
+//						Chrome trace JSON for Perfetto (ui.perfetto.dev) or
+//						chrome://tracing.
+//
+//		Notes:			The macros compile to nothing unless TRACE_ENABLE is
+//						defined for the whole build. To see task switches,
+//						FreeRTOSConfig.h needs:
+//
+//							#include "../common/Trace.h"
+//							#define traceTASK_SWITCHED_IN()	TRACE_TASK_SWITCHED_IN( pxCurrentTCB->pcTaskName )
+//
+//						Recording is a macro, so it is inline at each call
+//						site, and stores raw counts: the FreeRTOS tick,
+//						SysTick's current value and its pending bit.
+//						TraceDump() turns them into uS, using the SysTick
+//						reload the governor had set at the time, and task
+//						name pointers into names. The ring keeps the newest
+//						TRACE_EVENTS events and counts the ones it overwrote.
+//
+//*****************************************************************************
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+//*****************************************************************************
+//
+//	Event types
+//
+//*****************************************************************************
+#define TRACE_EVENT_TASK		1		// A task was switched in, ulArg = its name
+#define TRACE_EVENT_ISR_ENTER	2		// ulArg = TRACE_ISR_*
+#define TRACE_EVENT_ISR_EXIT	3
+#define TRACE_EVENT_BEGIN		4		// Span start, ulArg = TRACE_SPAN_*
+#define TRACE_EVENT_END			5
+#define TRACE_EVENT_MARK		6		// Instant, ulArg = TRACE_MARK_*
+#define TRACE_EVENT_CLOCK		7		// The governor changed the clock, ulArg = the old SysTick reload
+
+//*****************************************************************************
+//
+//	Interrupts
+//
+//*****************************************************************************
+#define TRACE_ISR_TIMER_0_A		0
+#define TRACE_ISR_UART0			1
+#define TRACE_ISRS				2
+
+//*****************************************************************************
+//
+//	Spans and marks share one set of names
+//
+//*****************************************************************************
+#define TRACE_SPAN_PING			0		// ProxySensor: trigger pulse to end of echo
+#define TRACE_SPAN_ECHO			1		// ProxySensor: busy waiting on the echo line
+#define TRACE_SPAN_DRAW			2		// Display: one RIT128x96x4 driver call
+#define TRACE_SPAN_TAKE			3		// Blocked in xSemaphoreTake()
+#define TRACE_MARK_GIVE			4		// xSemaphoreGive() or xSemaphoreGiveFromISR()
+#define TRACE_MARK_LATE			5		// Deadline.c saw a job finish late
+#define TRACE_USER				6
+
+//*****************************************************************************
+//
+//	One 12 byte event
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned long	ulTick;				// xPortSysTickCount
+	unsigned long	ulStamp;			// NVIC_ST_CURRENT, SysTick pending and the type
+	unsigned long	ulArg;
+} tTraceEvent;
+
+#define TRACE_STAMP_CURRENT		0x00FFFFFF	// NVIC_ST_CURRENT is 24 bits
+#define TRACE_STAMP_PENDING		0x04000000	// NVIC_INT_CTRL_PEND_SYST, in place
+#define TRACE_STAMP_TYPE_S		27
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS			1024	// Power of two; the host replay can afford more
+#endif
+
+#define TRACE_NAMES				16		// Tasks TraceDump() names; any more are named at every switch
+
+#ifdef TRACE_ENABLE
+
+#include "inc/hw_types.h"
+#include "inc/hw_nvic.h"
+#include "driverlib/cpu.h"
+
+#define TRACE_TASK_SWITCHED_IN( pcName )	TRACE_RECORD( TRACE_EVENT_TASK, ( unsigned long )( pcName ) )
+#define TRACE_ISR_ENTER( ucId )				TRACE_RECORD( TRACE_EVENT_ISR_ENTER, ( ucId ) )
+#define TRACE_ISR_EXIT( ucId )				TRACE_RECORD( TRACE_EVENT_ISR_EXIT, ( ucId ) )
+#define TRACE_BEGIN( ucId )					TRACE_RECORD( TRACE_EVENT_BEGIN, ( ucId ) )
+#define TRACE_END( ucId )					TRACE_RECORD( TRACE_EVENT_END, ( ucId ) )
+#define TRACE_MARK( ucId )					TRACE_RECORD( TRACE_EVENT_MARK, ( ucId ) )
+#define TRACE_CLOCK( ulReload )				TRACE_RECORD( TRACE_EVENT_CLOCK, ( ulReload ) )
+
+extern tTraceEvent g_psTrace[TRACE_EVENTS];
+extern volatile unsigned long g_ulTraceHead;		// Events recorded; the next slot is this mod TRACE_EVENTS
+extern volatile unsigned long g_bTraceActive;
+extern volatile int long xPortSysTickCount;
+
+//*****************************************************************************
+//
+//	Append one event, overwriting the oldest. Used from tasks, ISRs and
+//	the kernel's context switch, so the slot is claimed with interrupts off.
+//	The pending bit is read before the count: a SysTick that wraps between
+//	the two reads leaves the count near the reload, which TraceDump() also
+//	treats as the next tick.
+//
+//*****************************************************************************
+#define TRACE_RECORD( ulEventType, ulEventArg )													\
+	do {																						\
+		unsigned long ulTraceMasked;															\
+		unsigned long ulTracePending;															\
+		tTraceEvent *psTraceEvent;																\
+																								\
+		ulTraceMasked = CPUcpsid();																\
+		if ( g_bTraceActive ) {																	\
+			ulTracePending = HWREG( NVIC_INT_CTRL ) & TRACE_STAMP_PENDING;						\
+			psTraceEvent = &g_psTrace[g_ulTraceHead++ & ( TRACE_EVENTS - 1 )];					\
+			psTraceEvent->ulStamp = ( HWREG( NVIC_ST_CURRENT ) & TRACE_STAMP_CURRENT ) |		\
+									ulTracePending | ( ( ulEventType ) << TRACE_STAMP_TYPE_S );	\
+			psTraceEvent->ulTick = xPortSysTickCount;											\
+			psTraceEvent->ulArg = ( ulEventArg );												\
+		}																						\
+		if ( !ulTraceMasked ) {																	\
+			CPUcpsie();																			\
+		}																						\
+	} while ( 0 )
+
+extern void TraceStart( void );
+extern void TraceDump( void );
+
+#else
+
+#define TRACE_TASK_SWITCHED_IN( pcName )
+#define TRACE_ISR_ENTER( ucId )
+#define TRACE_ISR_EXIT( ucId )
+#define TRACE_BEGIN( ucId )
+#define TRACE_END( ucId )
+#define TRACE_MARK( ucId )
+#define TRACE_CLOCK( ulReload )
+
+#endif // TRACE_ENABLE
+
+#endif // __TRACE_H__
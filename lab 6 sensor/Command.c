@@ -0,0 +1,346 @@
+//*****************************************************************************
+//
+//	Command.c
+//
+//		Command/response protocol on UART0
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Receive framed commands on UART0 and answer them. The
+//						RX interrupt only moves bytes into a ring buffer and
+//						wakes the command task, which does the parsing at a
+//						low priority. See Command.h for the frame layout.
+//
+//*****************************************************************************
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+#include "Drivers/uartstdio.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "../common/Capture.h"
+#include "../common/ConfigStore.h"
+#include "../common/Deadline.h"
+#include "../common/Display.h"
+#include "../common/Governor.h"
+#include "../common/Trace.h"
+#include "Command.h"
+#include "TaskSet.h"
+
+//*****************************************************************************
+//
+//	Size of the RX ring buffer. Must be a power of two.
+//
+//*****************************************************************************
+#define CMD_RX_BUFFER_SIZE		128
+
+volatile tCommandStats g_sCommandStats;
+volatile unsigned char g_bCommandStream;
+
+static unsigned char g_pucRxBuffer[CMD_RX_BUFFER_SIZE];
+static volatile unsigned long g_ulRxHead;		// Written by the ISR
+static volatile unsigned long g_ulRxTail;		// Written by the task
+
+static xSemaphoreHandle Command_Rx_Semaphore;
+static xSemaphoreHandle Command_Uart_Mutex;
+
+//*****************************************************************************
+//
+//	UART0 interrupt. Drain the RX FIFO into the ring buffer and wake the
+//	command task.
+//
+//*****************************************************************************
+#pragma INTERRUPT (Command_UART0_ISR_Handler);
+
+__interrupt void Command_UART0_ISR_Handler() {
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	unsigned long ulNext;
+
+	TRACE_ISR_ENTER( TRACE_ISR_UART0 );
+
+	UARTIntClear( UART0_BASE, UARTIntStatus( UART0_BASE, true ) );
+
+	while ( UARTCharsAvail( UART0_BASE ) ) {
+		ulNext = ( g_ulRxHead + 1 ) & ( CMD_RX_BUFFER_SIZE - 1 );
+		if ( ulNext == g_ulRxTail ) {
+			// Buffer full, drop the byte. The frame it belongs to will fail its checksum.
+			UARTCharGetNonBlocking( UART0_BASE );
+			g_sCommandStats.ulRxOverruns++;
+		}
+		else {
+			g_pucRxBuffer[g_ulRxHead] = UARTCharGetNonBlocking( UART0_BASE );
+			g_ulRxHead = ulNext;
+		}
+	}
+
+	TRACE_MARK( TRACE_MARK_GIVE );
+	xSemaphoreGiveFromISR( Command_Rx_Semaphore, &xHigherPriorityTaskWoken );
+
+	TRACE_ISR_EXIT( TRACE_ISR_UART0 );
+
+	if ( xHigherPriorityTaskWoken ) {
+		vPortYieldFromISR( );
+	}
+}
+
+void CommandUartLock( void ) {
+	xSemaphoreTake( Command_Uart_Mutex, portMAX_DELAY );
+}
+
+long CommandUartTryLock( void ) {
+	return xSemaphoreTake( Command_Uart_Mutex, 0 ) == pdTRUE;
+}
+
+void CommandUartUnlock( void ) {
+	xSemaphoreGive( Command_Uart_Mutex );
+}
+
+//*****************************************************************************
+//
+//	Little endian helpers for 32 bit payload values.
+//
+//*****************************************************************************
+static void PutLong( unsigned char *pucData, unsigned long ulValue ) {
+	pucData[0] = ulValue;
+	pucData[1] = ulValue >> 8;
+	pucData[2] = ulValue >> 16;
+	pucData[3] = ulValue >> 24;
+}
+
+static unsigned long GetLong( const unsigned char *pucData ) {
+	return ( pucData[0] | ( pucData[1] << 8 ) | ( pucData[2] << 16 ) | ( (unsigned long)pucData[3] << 24 ) );
+}
+
+//*****************************************************************************
+//
+//	Send one reply frame. The status byte goes in front of pucData.
+//
+//*****************************************************************************
+static void CommandReply( unsigned char ucCmd, unsigned char ucStatus,
+						  const unsigned char *pucData, unsigned char ucLen ) {
+	unsigned char ucSum;
+	unsigned char ucIdx;
+
+	ucCmd |= CMD_RESPONSE;
+	ucSum = ucCmd + ( ucLen + 1 ) + ucStatus;
+
+	CommandUartLock();
+	UARTCharPut( UART0_BASE, CMD_SOF );
+	UARTCharPut( UART0_BASE, ucCmd );
+	UARTCharPut( UART0_BASE, ucLen + 1 );
+	UARTCharPut( UART0_BASE, ucStatus );
+	for ( ucIdx = 0; ucIdx < ucLen; ucIdx++ ) {
+		UARTCharPut( UART0_BASE, pucData[ucIdx] );
+		ucSum += pucData[ucIdx];
+	}
+	UARTCharPut( UART0_BASE, (unsigned char)( -ucSum ) );
+	CommandUartUnlock();
+}
+
+//*****************************************************************************
+//
+//	Act on one complete, checksummed frame.
+//
+//*****************************************************************************
+static void CommandDispatch( unsigned char ucCmd, unsigned char *pucData, unsigned char ucLen ) {
+	unsigned char pucReply[CMD_STAT_COUNT * 4];
+	unsigned long ulIdx;
+	long lStatus;
+
+	switch ( ucCmd ) {
+
+	case CMD_PING:
+		CommandReply( ucCmd, CMD_OK, pucData, ucLen );
+		break;
+
+	case CMD_GET:
+	case CMD_SET:
+		if ( ucLen != ( ucCmd == CMD_GET ? 1 : 5 ) ) {
+			CommandReply( ucCmd, CMD_ERR_LENGTH, 0, 0 );
+			break;
+		}
+		if ( pucData[0] >= CFG_COUNT ) {
+			CommandReply( ucCmd, CMD_ERR_PARAM, pucData, 1 );
+			break;
+		}
+		if ( ucCmd == CMD_SET ) {
+			lStatus = ConfigSet( pucData[0], GetLong( &pucData[1] ) );
+			if ( lStatus != CONFIG_OK ) {
+				CommandReply( ucCmd, lStatus == CONFIG_ERR_RANGE ? CMD_ERR_RANGE : CMD_ERR_FLASH, pucData, 1 );
+				break;
+			}
+			if ( pucData[0] == CFG_STREAM ) {
+				g_bCommandStream = ConfigGet( CFG_STREAM );
+			}
+		}
+		pucReply[0] = pucData[0];
+		PutLong( &pucReply[1], ConfigGet( pucData[0] ) );
+		CommandReply( ucCmd, CMD_OK, pucReply, 5 );
+		break;
+
+	// Until reset only. Saving the setting is a CMD_SET of CFG_STREAM, so
+	// toggling the stream never costs a flash write.
+	case CMD_STREAM_START:
+	case CMD_STREAM_STOP:
+		g_bCommandStream = ( ucCmd == CMD_STREAM_START );
+		CommandReply( ucCmd, CMD_OK, 0, 0 );
+		break;
+
+	case CMD_STATS:
+		g_sCommandStats.ulDeadlineMisses = DeadlineMisses();
+		for ( ulIdx = 0; ulIdx < CMD_STAT_COUNT; ulIdx++ ) {
+			PutLong( &pucReply[ulIdx * 4], ( (volatile unsigned long *)&g_sCommandStats )[ulIdx] );
+		}
+		CommandReply( ucCmd, CMD_OK, pucReply, CMD_STAT_COUNT * 4 );
+		break;
+
+	case CMD_CAPTURE_START:
+		CaptureStart();
+		CommandReply( ucCmd, CMD_OK, 0, 0 );
+		break;
+
+	case CMD_CAPTURE_DUMP:
+		CommandUartLock();
+		CaptureDump();
+		CommandUartUnlock();
+		CommandReply( ucCmd, CMD_OK, 0, 0 );
+		break;
+
+	case CMD_DEADLINES:
+		CommandUartLock();
+		DeadlineReport();
+		DisplayReport();
+		GovernorReport();
+		CommandUartUnlock();
+		CommandReply( ucCmd, CMD_OK, 0, 0 );
+		break;
+
+#ifdef TRACE_ENABLE
+	case CMD_TRACE_DUMP:
+		CommandUartLock();
+		TraceDump();
+		CommandUartUnlock();
+		CommandReply( ucCmd, CMD_OK, 0, 0 );
+		break;
+#endif
+
+	default:
+		CommandReply( ucCmd, CMD_ERR_UNKNOWN, 0, 0 );
+		break;
+	}
+}
+
+//*****************************************************************************
+//
+//	Command task. Sleeps until the RX interrupt has new bytes, then runs them
+//	through the frame state machine.
+//
+//*****************************************************************************
+static void Command( void *pvParameters ) {
+	enum { WAIT_SOF, WAIT_CMD, WAIT_LEN, WAIT_DATA, WAIT_SUM } eState = WAIT_SOF;
+	unsigned char pucData[CMD_MAX_PAYLOAD];
+	unsigned char ucCmd = 0;
+	unsigned char ucLen = 0;
+	unsigned char ucCount = 0;
+	unsigned char ucSum = 0;
+	unsigned char ucByte;
+	static tDeadline CommandDeadline;
+
+	// Sporadic task; the period is the minimum spacing assumed between commands.
+	DeadlineRegister( &CommandDeadline, "Command", COMMAND_TASK_PERIOD_MS );
+
+	while ( 1 ) {
+
+		TRACE_BEGIN( TRACE_SPAN_TAKE );
+		xSemaphoreTake( Command_Rx_Semaphore, portMAX_DELAY );
+		TRACE_END( TRACE_SPAN_TAKE );
+		DeadlineRelease( &CommandDeadline );
+
+		while ( g_ulRxTail != g_ulRxHead ) {
+			ucByte = g_pucRxBuffer[g_ulRxTail];
+			g_ulRxTail = ( g_ulRxTail + 1 ) & ( CMD_RX_BUFFER_SIZE - 1 );
+
+			switch ( eState ) {
+			case WAIT_SOF:
+				if ( ucByte == CMD_SOF ) {
+					eState = WAIT_CMD;
+				}
+				break;
+			case WAIT_CMD:
+				ucCmd = ucByte;
+				ucSum = ucByte;
+				eState = WAIT_LEN;
+				break;
+			case WAIT_LEN:
+				ucLen = ucByte;
+				ucSum += ucByte;
+				ucCount = 0;
+				if ( ucLen > CMD_MAX_PAYLOAD ) {
+					g_sCommandStats.ulFramesBad++;
+					eState = WAIT_SOF;
+				}
+				else {
+					eState = ( ucLen == 0 ) ? WAIT_SUM : WAIT_DATA;
+				}
+				break;
+			case WAIT_DATA:
+				pucData[ucCount++] = ucByte;
+				ucSum += ucByte;
+				if ( ucCount == ucLen ) {
+					eState = WAIT_SUM;
+				}
+				break;
+			case WAIT_SUM:
+				if ( (unsigned char)( ucSum + ucByte ) == 0 ) {
+					g_sCommandStats.ulFramesOk++;
+					CommandDispatch( ucCmd, pucData, ucLen );
+				}
+				else {
+					g_sCommandStats.ulFramesBad++;
+				}
+				eState = WAIT_SOF;
+				break;
+			}
+		}
+
+		DeadlineComplete( &CommandDeadline );
+	}
+}
+
+void CommandInit( unsigned long ulPriority ) {
+
+	// Enable UART0, to be used as a serial console and for commands.
+	//
+	SysCtlPeripheralEnable( SYSCTL_PERIPH_GPIOA );
+	SysCtlPeripheralEnable( SYSCTL_PERIPH_UART0 );
+	GPIOPinTypeUART( GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1 );
+	//
+	// Initialize the UART standard I/O.
+	//
+	UARTStdioInit( 0 );
+
+	g_bCommandStream = ConfigGet( CFG_STREAM );
+
+	vSemaphoreCreateBinary( Command_Rx_Semaphore );
+	xSemaphoreTake( Command_Rx_Semaphore, 0 );
+	Command_Uart_Mutex = xSemaphoreCreateMutex();
+
+	// The handler gives a semaphore, so it must not run above the kernel's
+	// syscall ceiling. Set the priority before UARTIntRegister() enables it;
+	// the reset priority of 0 is above the ceiling.
+	IntPrioritySet( INT_UART0, configKERNEL_INTERRUPT_PRIORITY );
+
+	// Interrupt on RX FIFO level and on RX timeout, so short frames are not left in the FIFO.
+	UARTIntRegister( UART0_BASE, Command_UART0_ISR_Handler );
+	UARTIntEnable( UART0_BASE, UART_INT_RX | UART_INT_RT );
+
+	xTaskCreate( Command, ( signed portCHAR * ) "Command", 256, NULL, ulPriority, NULL );
+}
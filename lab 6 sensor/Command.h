@@ -0,0 +1,122 @@
+//*****************************************************************************
+//
+//	Command.h
+//
+//		Command/response protocol on UART0
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Lets a host read and change runtime parameters, start
+//						and stop the reading stream and pull statistics without
+//						reflashing the board.
+//
+//		Notes:			Every frame, in both directions, is laid out as
+//
+//							SOF | command | length | payload[length] | checksum
+//
+//						The checksum is chosen so that command, length, payload
+//						and checksum add up to 0 (mod 256). A reply echoes the
+//						command with CMD_RESPONSE set, and the first payload
+//						byte of a reply is always a CMD_OK/CMD_ERR_* status.
+//						Multi-byte values are little endian.
+//
+//*****************************************************************************
+
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+//*****************************************************************************
+//
+//	Framing
+//
+//*****************************************************************************
+#define CMD_SOF					0x7E
+#define CMD_MAX_PAYLOAD			32
+#define CMD_RESPONSE			0x80
+
+//*****************************************************************************
+//
+//	Commands
+//
+//*****************************************************************************
+#define CMD_PING				0x01	// Echo the payload back
+#define CMD_GET					0x02	// id -> id, value[4]
+#define CMD_SET					0x03	// id, value[4] -> id, value[4]
+#define CMD_STREAM_START		0x04	// Print a line per reading, until reset
+#define CMD_STREAM_STOP			0x05	// Stop printing readings, until reset
+#define CMD_STATS				0x06	// -> CMD_STAT_COUNT values[4]
+#define CMD_CAPTURE_START		0x07	// Start recording a replay capture
+#define CMD_CAPTURE_DUMP		0x08	// Print the capture as "capture:" lines, then reply
+#define CMD_DEADLINES			0x09	// Print the "deadline:", "display:" and "governor:" reports, then reply
+#define CMD_TRACE_DUMP			0x0A	// Print the trace as "trace:" lines, then reply (TRACE_ENABLE builds)
+
+//*****************************************************************************
+//
+//	Reply status
+//
+//*****************************************************************************
+#define CMD_OK					0x00
+#define CMD_ERR_UNKNOWN			0x01	// Command not recognized
+#define CMD_ERR_LENGTH			0x02	// Payload length wrong for command
+#define CMD_ERR_PARAM			0x03	// No such parameter
+#define CMD_ERR_RANGE			0x04	// Value outside the parameter limits
+#define CMD_ERR_FLASH			0x05	// Value could not be saved
+
+//*****************************************************************************
+//
+//	Parameter ids for CMD_GET and CMD_SET are the CFG_* keys in
+//	ConfigStore.h. A successful CMD_SET is saved to flash. CFG_STREAM is the
+//	stream setting at boot; setting it also starts or stops the stream.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//	Statistics returned by CMD_STATS, in this order
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned long	ulPings;			// Measurements taken
+	unsigned long	ulLastEcho;			// Last echo width in timer counts
+	unsigned long	ulFramesOk;			// Frames accepted
+	unsigned long	ulFramesBad;		// Frames dropped on checksum/length
+	unsigned long	ulRxOverruns;		// Bytes lost to a full RX buffer
+	unsigned long	ulDeadlineMisses;	// Late plus lost jobs over all tasks
+	unsigned long	ulStreamSkipped;	// Stream lines skipped while UART0 was held
+} tCommandStats;
+
+#define CMD_STAT_COUNT			( sizeof( tCommandStats ) / sizeof( unsigned long ) )
+
+extern volatile tCommandStats g_sCommandStats;
+
+//*****************************************************************************
+//
+//	True while readings are streamed on UART0. Starts as CFG_STREAM and is
+//	kept in RAM, so CMD_STREAM_START/STOP do not write flash. Not a tBoolean,
+//	so that tools/cmdclient.c can include this header.
+//
+//*****************************************************************************
+extern volatile unsigned char g_bCommandStream;
+
+//*****************************************************************************
+//
+//	Set up UART0 and its RX interrupt and create the command task. Call from
+//	main() before the scheduler is started.
+//
+//*****************************************************************************
+extern void CommandInit( unsigned long ulPriority );
+
+//*****************************************************************************
+//
+//	UART0 is shared between command replies and UARTprintf() output. Hold
+//	the lock while writing so a reply is never split by a printed line.
+//	CommandUartTryLock() returns non-zero if it took the lock, and zero at
+//	once if another task holds it.
+//
+//*****************************************************************************
+extern void CommandUartLock( void );
+extern long CommandUartTryLock( void );
+extern void CommandUartUnlock( void );
+
+#endif // __COMMAND_H__
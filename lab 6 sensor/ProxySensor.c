@@ -27,11 +27,24 @@
 #include "driverlib/gpio.h"
 #include "driverlib/timer.h"
 #include "Drivers/rit128x96x4.h"
-#include "drivers/uartstdio.h"
+#include "Drivers/uartstdio.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "stdio.h"
-
+#include "utils/ustdlib.h"
+#include "../common/Capture.h"
+#include "../common/ConfigStore.h"
+#include "../common/Deadline.h"
+#include "../common/Display.h"
+#include "../common/Governor.h"
+#include "../common/Trace.h"
+#include "Command.h"
+
+// Full scale of the range bar graph. The PING sensor is rated to 3 m, but
+// Timer_0_A is a 16 bit timer counting at 5 MHz (CFG_TIMER_PRESCALE 9 at
+// 50 MHz, kept by the governor) and wraps after 13.1 mS, about 2.2 m of
+// round trip. Longer echoes cannot be told from short ones.
+#define PING_RANGE_MAX_MM		2200
 
 
 //*****************************************************************************
@@ -39,16 +52,11 @@
 // Task initialization
 void ProxySensor( void *pvParameters ) {
 
-	// Enable UART0, to be used as a serial console.
-	//
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
-	GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-	//
-	// Initialize the UART standard I/O.
+	// UART0 is set up by CommandInit() so the command task can share it.
 	//
-	UARTStdioInit( 0 );
+	CommandUartLock();
 	UARTprintf( "Task_Button on LM3S1968 starting\n" );
+	CommandUartUnlock();
 
 
 	//*****************************************************************************
@@ -76,15 +84,23 @@ void ProxySensor( void *pvParameters ) {
 	//
 	SysCtlPeripheralEnable( SYSCTL_PERIPH_TIMER0 );
 	TimerConfigure( TIMER0_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PERIODIC );
-	TimerLoadSet( TIMER0_BASE, TIMER_A, 50000 );
-	TimerPrescaleSet( TIMER0_BASE, TIMER_A, 9 );
+	TimerLoadSet( TIMER0_BASE, TIMER_A, ConfigGet( CFG_TIMER_LOAD ) );
+	TimerPrescaleSet( TIMER0_BASE, TIMER_A, GovernorTimerPrescale() );
+
+	static tDeadline ProxySensorDeadline;
 
 	long int signal_send_termination;
 	long int signal_receive_start;
 	long int signal_receive_end;
+	unsigned long range_mm;
+	char DisplayString[DISPLAY_COLUMNS + 1];
 
 	TimerEnable( TIMER0_BASE, TIMER_A );								// Starts the timer counting down.
 
+	DeadlineRegister( &ProxySensorDeadline, "ProxySensor", ConfigGet( CFG_PING_PERIOD ) );
+
+	DisplayText( DISPLAY_TITLE, " ProxySensor" );
+
 
 	while ( 1 ) {
 
@@ -123,31 +139,45 @@ void ProxySensor( void *pvParameters ) {
 		GPIOPinTypeGPIOOutput( GPIO_PORTD_BASE, GPIO_PIN_1 );
 		GPIOPadConfigSet( GPIO_PORTD_BASE, GPIO_PIN_1, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD );
 
+		CAPTURE_EVENT( CAPTURE_PING, 0, 0 );
+		TRACE_BEGIN( TRACE_SPAN_PING );
+
 		GPIOPinWrite( GPIO_PORTD_BASE, GPIO_PIN_1, 0x00 );
-		SysCtlDelay( 100 );
+		SysCtlDelay( GovernorScale( ConfigGet( CFG_PING_SETTLE ) ) );
 		GPIOPinWrite( GPIO_PORTD_BASE, GPIO_PIN_1, 0x02 );					// Begins 1 signal output.
-		SysCtlDelay( 60 ) ;													// Waits ~5us, the length of typical PING sensor signal.
+		SysCtlDelay( GovernorScale( ConfigGet( CFG_PING_PULSE ) ) ) ;		// Waits ~5us, the length of typical PING sensor signal.
 		GPIOPinWrite( GPIO_PORTD_BASE, GPIO_PIN_1, 0x00 );					// After wait, pulls signal back down to zero.
-		SysCtlDelay( 100 );
+		SysCtlDelay( GovernorScale( ConfigGet( CFG_PING_SETTLE ) ) );
 
 		// Configure PortG[1] as INPUT.
 		GPIOPinTypeGPIOInput( GPIO_PORTD_BASE, GPIO_PIN_1 );
 		GPIOPadConfigSet( GPIO_PORTD_BASE, GPIO_PIN_1, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_OD );
 
 		// Waits here for the return signal from the sensor. Sensor replies with 1's.
+		TRACE_BEGIN( TRACE_SPAN_ECHO );
 		while ( GPIOPinRead( GPIO_PORTD_BASE, GPIO_PIN_1 ) == 0 ) {
 			//UARTprintf( "signal value: %d,\n", GPIOPinRead( GPIO_PORTD_BASE, GPIO_PIN_1 )); // FOR TESTING
 		}
+		CAPTURE_EVENT( CAPTURE_EDGE, 1, 0 );
 		TimerLoadSet( TIMER0_BASE, TIMER_A, 0xFFFF );						// Load timer to maximum
 		// Records time that low-high RX occurred. This is when the RX signal starts.
 		signal_receive_start = TimerValueGet( TIMER0_BASE, TIMER_A );
+		CAPTURE_EVENT( CAPTURE_TIMER, 0, signal_receive_start );
 
 
-		// Waits here for RX signal to end. Signal drops back to 0.
-		while ( GPIOPinRead( GPIO_PORTD_BASE, GPIO_PIN_1 ) == 1 ) {
+		// Waits here for RX signal to end. Signal drops back to 0. GPIOPinRead()
+		// returns the pin's bit, 0x02, while it is high.
+		while ( GPIOPinRead( GPIO_PORTD_BASE, GPIO_PIN_1 ) != 0 ) {
 		}
+		CAPTURE_EVENT( CAPTURE_EDGE, 0, 0 );
 		// Records time that high-low RX occurred. This is when the RX signal ends.
-		signal_receive_end = TimerValueGet( TIMER0_BASE, TIMER_A ) - signal_receive_start;
+		signal_receive_end = TimerValueGet( TIMER0_BASE, TIMER_A );
+		CAPTURE_EVENT( CAPTURE_TIMER, 0, signal_receive_end );
+		TRACE_END( TRACE_SPAN_ECHO );
+		TRACE_END( TRACE_SPAN_PING );
+		// Timer counts down from 0xFFFF and wraps, so the echo is the
+		// difference modulo 0x10000.
+		signal_receive_end = ( signal_receive_start - signal_receive_end ) & 0xFFFF;
 
 
 		// Send time values over Uart.
@@ -155,8 +185,40 @@ void ProxySensor( void *pvParameters ) {
 		//	signal_receive_start - signal_send_termination,
 		//	signal_receive_end - signal_receive_start );
 
-		UARTprintf( "signal value: %d,\n", GPIOPinRead( GPIO_PORTD_BASE, GPIO_PIN_1 ));
+		g_sCommandStats.ulLastEcho = signal_receive_end;
+		g_sCommandStats.ulPings++;
+
+		// Echo time in uS from the timer counts, then sound at 343 m/s over the round trip.
+		// The governor cannot change the clock between the reading and here.
+		range_mm = signal_receive_end * ( TimerPrescaleGet( TIMER0_BASE, TIMER_A ) + 1 ) / ( SysCtlClockGet() / 1000000 );
+		range_mm = range_mm * 343 / 2000;
+		if ( range_mm > PING_RANGE_MAX_MM ) {
+			range_mm = PING_RANGE_MAX_MM;
+		}
+
+		// Posted every ping; the compositor draws the newest once per frame.
+		usnprintf( DisplayString, sizeof( DisplayString ), "Range: %u mm", range_mm );
+		DisplayText( DISPLAY_RANGE, DisplayString );
+		DisplayBar( range_mm * DISPLAY_BAR_MAX / PING_RANGE_MAX_MM );
+		usnprintf( DisplayString, sizeof( DisplayString ), "pings %u miss %u", g_sCommandStats.ulPings, DeadlineMisses() );
+		DisplayText( DISPLAY_STATS, DisplayString );
+
+		// Never wait for UART0: a reply or dump in progress would hold up the
+		// next ping. The line is skipped and counted instead.
+		if ( g_bCommandStream ) {
+			if ( CommandUartTryLock() ) {
+				UARTprintf( "signal value: %d,\n", GPIOPinRead( GPIO_PORTD_BASE, GPIO_PIN_1 ));
+				CommandUartUnlock();
+			}
+			else {
+				g_sCommandStats.ulStreamSkipped++;
+			}
+		}
 
+		// Ranging rate is set at runtime through CFG_PING_PERIOD. Each measurement
+		// must finish within one period.
+		ProxySensorDeadline.ulPeriod = ConfigGet( CFG_PING_PERIOD ) / portTICK_RATE_MS;
+		DeadlineDelayUntil( &ProxySensorDeadline );
 
 	}
 
@@ -0,0 +1,89 @@
+//*****************************************************************************
+//
+//	TaskSet.h
+//
+//		Lab 6 task set: periods, worst case execution times and priorities
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Priorities are rate monotonic: the shorter the period,
+//						the higher the priority. tools/rmsched reads this file
+//						to check the set is schedulable and to compare it with
+//						the "deadline:" lines the firmware reports.
+//
+//		Notes:			Every task has three defines, NAME_TASK_PERIOD_MS,
+//						NAME_TASK_WCET_US and NAME_TASK_PRIORITY, where NAME is
+//						the name the task registers with Deadline.c. Keep the
+//						priorities below configMAX_PRIORITIES. A task that can
+//						hold up a higher priority one, with a critical section,
+//						a suspended scheduler or a flash write, also has
+//						NAME_TASK_BLOCK_US, the longest it does so per job.
+//
+//						WCETs hold at the slowest clock the governor may
+//						pick, TASKSET_SYSDIV_MAX: time spent waiting on the
+//						PING echo, SSI, UART0 or flash is the same at any
+//						clock, and CPU time is 2.5 times what it is at the
+//						50 MHz of CFG_SYSDIV 4.
+//
+//*****************************************************************************
+
+#ifndef __TASKSET_H__
+#define __TASKSET_H__
+
+// 20 MHz. GovernorInit() uses no slower divisor.
+#define TASKSET_SYSDIV_MAX				10
+
+//
+// ProxySensor: one PING measurement per period. The WCET is the longest echo
+// (18.5 mS, no object in range) plus the trigger pulse and holdoff, and 1 mS
+// of CPU at 50 MHz for the range and the pane strings. The period is the
+// default for CFG_PING_PERIOD. The set still passes with it down to 49 mS,
+// so ConfigStore rejects periods below 50 mS; a longer WCET here needs that
+// minimum checked again. It blocks others only while posting to a display
+// slot; a stream line that finds UART0 held is skipped rather than waited for.
+//
+#define PROXYSENSOR_TASK_PERIOD_MS		60
+#define PROXYSENSOR_TASK_WCET_US		21000
+#define PROXYSENSOR_TASK_PRIORITY		( tskIDLE_PRIORITY + 4 )
+#define PROXYSENSOR_TASK_BLOCK_US		10
+
+//
+// Display: the OLED compositor, one frame per period (10 frames/s). Below
+// ProxySensor so a redraw cannot stretch an echo measurement. The WCET is
+// redrawing every pane: about 2450 bytes over SSI at the default 1 MHz
+// CFG_OLED_FREQUENCY (19.6 mS), plus the OLED driver packing them, taken as
+// 100 cycles a byte (4.9 mS at 50 MHz). It blocks others while copying out
+// a pane slot.
+//
+#define DISPLAY_TASK_PERIOD_MS			100
+#define DISPLAY_TASK_WCET_US			32000
+#define DISPLAY_TASK_PRIORITY			( tskIDLE_PRIORITY + 3 )
+#define DISPLAY_TASK_BLOCK_US			10
+
+//
+// Command: sporadic, released by the UART0 RX interrupt. The period is the
+// minimum spacing assumed between host commands. The WCET is a CMD_SET that
+// compacts the config store: two 20 mS page erases and 21 word programs at
+// 20 uS, about 40.4 mS, plus 0.6 mS of CPU at 50 MHz to parse the command
+// and send its reply. The CPU stalls during an erase, so one erase also
+// blocks every higher priority task. CMD_CAPTURE_DUMP and CMD_TRACE_DUMP
+// print for hundreds of mS and are outside this analysis.
+//
+#define COMMAND_TASK_PERIOD_MS			200
+#define COMMAND_TASK_WCET_US			42000
+#define COMMAND_TASK_PRIORITY			( tskIDLE_PRIORITY + 2 )
+#define COMMAND_TASK_BLOCK_US			20000
+
+//
+// Governor: one clock scaling decision per period. The WCET is draining the
+// UART0 FIFO (16 characters at 115200 baud, 1.4 mS) before a switch plus
+// setting up SysTick, Timer_0_A, UART0 and SSI0 again, 0.6 mS of CPU at
+// 50 MHz. The drain runs with the scheduler suspended and the switch with
+// interrupts masked, so all of it blocks.
+//
+#define GOVERNOR_TASK_PERIOD_MS			1000
+#define GOVERNOR_TASK_WCET_US			3000
+#define GOVERNOR_TASK_PRIORITY			( tskIDLE_PRIORITY + 1 )
+#define GOVERNOR_TASK_BLOCK_US			3000
+
+#endif // __TASKSET_H__
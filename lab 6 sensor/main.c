@@ -37,6 +37,11 @@
 #include "driverlib/adc.h"
 #include "stdio.h"
 #include "queue.h"
+#include "../common/ConfigStore.h"
+#include "../common/Display.h"
+#include "../common/Governor.h"
+#include "Command.h"
+#include "TaskSet.h"
 
 //*****************************************************************************
 //
@@ -110,11 +115,27 @@ void BlinkLED(void *pvParameters){
 extern void ProxySensor( void *pvParameters );
 
 
+//*****************************************************************************
+//
+//	Idle hook (configUSE_IDLE_HOOK 1). The governor sleeps here and measures
+//	the CPU load from the time spent asleep.
+//
+//*****************************************************************************
+void vApplicationIdleHook( void ) {
+	GovernorIdle();
+}
+
+
 int main(void) {
+    //
+    // Load the stored configuration and calibration values. The clock divisor comes from here.
+    //
+    ConfigInit();
+
     //
     // Set the clocking to run directly from the crystal.
     //
-    SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ);
+    SysCtlClockSet(CONFIG_SYSCTL_SYSDIV(ConfigGet(CFG_SYSDIV)) | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ);
 
 	//xTaskCreate(BlinkLED, (signed portCHAR*) "Blinky", 256, NULL, 1, NULL);
 	
@@ -124,8 +145,18 @@ int main(void) {
 	//xTaskCreate(Uart, (signed portCHAR*) "Uart", 256, NULL, 1, NULL);
 	
 	
+	// UART0 console and the command task that lets a host change parameters at runtime
+	// Priorities are rate monotonic, see TaskSet.h.
+	CommandInit( COMMAND_TASK_PRIORITY );
+
+	// OLED compositor. ProxySensor posts the range, bar graph and statistics panes to it.
+	DisplayInit( DISPLAY_TASK_PRIORITY, DISPLAY_TASK_PERIOD_MS );
+
+	// Clock scaling. Runs below everything else and only slows the clock while the deadlines allow it.
+	GovernorInit( GOVERNOR_TASK_PRIORITY, GOVERNOR_TASK_PERIOD_MS, TASKSET_SYSDIV_MAX );
+
 	// initialize the proxysensor task
-	xTaskCreate( ProxySensor, ( signed portCHAR * ) "ProxySensor", 512, NULL, 1, NULL );
+	xTaskCreate( ProxySensor, ( signed portCHAR * ) "ProxySensor", 512, NULL, PROXYSENSOR_TASK_PRIORITY, NULL );
 
 
 	//
@@ -0,0 +1,88 @@
+//*****************************************************************************
+//
+//	TaskSet.h
+//
+//		Lab 8 task set: periods, worst case execution times and priorities
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Priorities are rate monotonic: the shorter the period,
+//						the higher the priority. tools/rmsched reads this file
+//						to check the set is schedulable and to compare it with
+//						the "deadline:" lines the firmware reports.
+//
+//		Notes:			Every task has three defines, NAME_TASK_PERIOD_MS,
+//						NAME_TASK_WCET_US and NAME_TASK_PRIORITY, where NAME is
+//						the name the task registers with Deadline.c. Keep the
+//						priorities below configMAX_PRIORITIES. A task that can
+//						hold up a higher priority one, with a critical section,
+//						a suspended scheduler or a flash write, also has
+//						NAME_TASK_BLOCK_US, the longest it does so per job.
+//
+//						WCETs hold at the slowest clock the governor may
+//						pick, TASKSET_SYSDIV_MAX: time spent waiting on SSI
+//						or UART0 is the same at any clock, and CPU time is
+//						2.5 times what it is at the 50 MHz of CFG_SYSDIV 4.
+//
+//*****************************************************************************
+
+#ifndef __TASKSET_H__
+#define __TASKSET_H__
+
+// 20 MHz. GovernorInit() uses no slower divisor.
+#define TASKSET_SYSDIV_MAX				10
+
+//
+// TimeOfDay: released by Timer_0_A every 10 mS (load 50000, prescale 10 at
+// 50 MHz). The WCET is formatting the time and posting it to the display,
+// 200 uS of CPU at 50 MHz.
+//
+#define TIMEOFDAY_TASK_PERIOD_MS		10
+#define TIMEOFDAY_TASK_WCET_US			500
+#define TIMEOFDAY_TASK_PRIORITY			( tskIDLE_PRIORITY + 4 )
+#define TIMEOFDAY_TASK_BLOCK_US			10
+
+//
+// Display: the OLED compositor, one frame per period (20 frames/s). The WCET
+// is redrawing every pane: about 2450 bytes over SSI at the default 1 MHz
+// CFG_OLED_FREQUENCY (19.6 mS), plus the OLED driver packing them, taken as
+// 100 cycles a byte (4.9 mS at 50 MHz). It blocks others while copying out
+// a pane slot.
+//
+#define DISPLAY_TASK_PERIOD_MS			50
+#define DISPLAY_TASK_WCET_US			32000
+#define DISPLAY_TASK_PRIORITY			( tskIDLE_PRIORITY + 3 )
+#define DISPLAY_TASK_BLOCK_US			10
+
+//
+// Blinky: toggles the status LED, 50 uS of CPU at 50 MHz.
+//
+#define BLINKY_TASK_PERIOD_MS			250
+#define BLINKY_TASK_WCET_US				125
+#define BLINKY_TASK_PRIORITY			( tskIDLE_PRIORITY + 2 )
+
+//
+// Uart: console, posts the display statistics and prints the deadline,
+// display and governor reports. The WCET is a seven line report sent by
+// polling at 115200 baud (about 30 mS) plus 0.4 mS of CPU at 50 MHz to
+// format it. The one time capture and trace dumps of a
+// CAPTURE_ENABLE or TRACE_ENABLE build are outside this analysis.
+//
+#define UART_TASK_PERIOD_MS				1000
+#define UART_TASK_WCET_US				31000
+#define UART_TASK_PRIORITY				( tskIDLE_PRIORITY + 1 )
+#define UART_TASK_BLOCK_US				10
+
+//
+// Governor: one clock scaling decision per period. The WCET is draining the
+// UART0 FIFO (16 characters at 115200 baud, 1.4 mS) before a switch plus
+// setting up SysTick, Timer_0_A, UART0 and SSI0 again, 0.6 mS of CPU at
+// 50 MHz. The drain runs with the scheduler suspended and the switch with
+// interrupts masked, so all of it blocks.
+//
+#define GOVERNOR_TASK_PERIOD_MS			1000
+#define GOVERNOR_TASK_WCET_US			3000
+#define GOVERNOR_TASK_PRIORITY			( tskIDLE_PRIORITY + 1 )
+#define GOVERNOR_TASK_BLOCK_US			3000
+
+#endif // __TASKSET_H__
@@ -27,16 +27,23 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/systick.h"
 #include "driverlib/gpio.h"
-#include "Drivers/rit128x96x4.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
 #include "Drivers/uartstdio.h"
+#include "utils/ustdlib.h"
 
 #include "stdio.h"
 #include "semphr.h"
 #include "driverlib/timer.h"
 #include "driverlib/interrupt.h"
+#include "../common/Capture.h"
+#include "../common/ConfigStore.h"
+#include "../common/Deadline.h"
+#include "../common/Display.h"
+#include "../common/Governor.h"
+#include "../common/Trace.h"
+#include "TaskSet.h"
 
 //*****************************************************************************
 //
@@ -67,29 +74,53 @@ void Uart(void *pvParameters){
 	UARTStdioInit( 0 );
 	UARTprintf( "Task_Button on LM3S1968 starting\n" );
 
+	static tDeadline UartDeadline;
+	unsigned long ReportCount = 0;
+	char StatsString[DISPLAY_COLUMNS + 1];
+
+	DeadlineRegister(&UartDeadline, "Uart", UART_TASK_PERIOD_MS);
+
+#ifdef CAPTURE_ENABLE
+	char CaptureDumped = 0;
+#endif
+#ifdef TRACE_ENABLE
+	char TraceDumped = 0;
+#endif
+
 	while(1){
 		//UARTprintf("%d\n",str);
-		vTaskDelay(1000);
+#ifdef CAPTURE_ENABLE
+		// Print the boot capture for tools/replay once the buffer has filled.
+		if(!CaptureDumped && CaptureCount() == CAPTURE_EVENTS){
+			CaptureDump();
+			CaptureDumped = 1;
+		}
+#endif
+		// Show what the display itself costs, from the compositor's last one second window.
+		// usnprintf() keeps it to one pane row.
+		usnprintf(StatsString, sizeof(StatsString), "ssi %uB/s %u.%u%%", g_sDisplayStats.ulSsiRate,
+				g_sDisplayStats.ulCpuPermille / 10, g_sDisplayStats.ulCpuPermille % 10);
+		DisplayText(DISPLAY_STATS, StatsString);
+
+		// Print response times and deadline misses every 10 periods for tools/rmsched.
+		if(++ReportCount == 10){
+			DeadlineReport();
+			DisplayReport();
+			GovernorReport();
+			ReportCount = 0;
+#ifdef TRACE_ENABLE
+			// The last TRACE_EVENTS events before the first report, for tools/trace2json.
+			if(!TraceDumped){
+				TraceDump();
+				TraceDumped = 1;
+			}
+#endif
+		}
+		DeadlineDelayUntil(&UartDeadline);
 	}
 
 }
 
-void PrintInit(){
-    //
-	// 	Code to cause a wait for a "Select Button" press
-    //
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOG);
-	GPIOPinTypeGPIOInput(GPIO_PORTG_BASE, GPIO_PIN_7);
-    GPIOPadConfigSet(GPIO_PORTG_BASE, GPIO_PIN_7, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
-	RIT128x96x4Init(1000000);
-	RIT128x96x4StringDraw("FreeRTOS starting\n", 8, 0, 15);
-	RIT128x96x4StringDraw("Press \"Select\" Button", 0, 24, 15);
-	RIT128x96x4StringDraw("To Continue", 32, 32, 15);
-	while(GPIOPinRead(GPIO_PORTG_BASE, GPIO_PIN_7));
-	SysCtlPeripheralReset(SYSCTL_PERIPH_GPIOG);
-	SysCtlPeripheralDisable(SYSCTL_PERIPH_GPIOG);
-}
-
 //*****************************************************************************
 //
 //	Task to blink the LED
@@ -108,6 +139,9 @@ void BlinkLED(void *pvParameters){
     GPIOPadConfigSet(GPIO_PORTG_BASE, GPIO_PIN_2, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
 
 	unsigned long LED_Data = 0;
+	static tDeadline BlinkyDeadline;
+
+	DeadlineRegister(&BlinkyDeadline, "Blinky", BLINKY_TASK_PERIOD_MS);
 
 	while(1){
 		//
@@ -117,7 +151,7 @@ void BlinkLED(void *pvParameters){
 		LED_Data = LED_Data ^ 0x04;
 		GPIOPinWrite(GPIO_PORTG_BASE, GPIO_PIN_2, LED_Data);
 
-		vTaskDelay(250);
+		DeadlineDelayUntil(&BlinkyDeadline);
 	}
 }
 
@@ -138,10 +172,16 @@ static char cSeconds = 0;
 
 xSemaphoreHandle Timer_0_A_Semaphore;
 
+// Each Timer_0_A interrupt releases one Task_TimeOfDay job.
+static tDeadline TimeOfDayDeadline;
+
 
 
 extern void Task_TimeOfDay(void *pvParameters){
 
+	// Registered before the interrupt that releases this task is enabled
+	DeadlineRegister(&TimeOfDayDeadline, "TimeOfDay", TIMEOFDAY_TASK_PERIOD_MS);
+
 	// Enable the timer hardware
 	SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
 	
@@ -149,12 +189,12 @@ extern void Task_TimeOfDay(void *pvParameters){
 	TimerConfigure( TIMER0_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PERIODIC);
 	
 	// Set the prescale value. This is the factor that the timer bit counter will be divided by
-	// to determine its period. Here, we divide by TEN, but the hardware wants a 9, because it starts
-	// at index 0
-	TimerPrescaleSet( TIMER0_BASE, TIMER_A, 9);
+	// to determine its period. By default we divide by TEN, but the hardware wants a 9, because it starts
+	// at index 0. Stored as CFG_TIMER_PRESCALE for the full clock; the governor scales it with the clock.
+	TimerPrescaleSet( TIMER0_BASE, TIMER_A, GovernorTimerPrescale());
 	
-	// Set a load value. After the timer reaches zero, reset the timer to 50000*period time.
-	TimerLoadSet( TIMER0_BASE, TIMER_A, 50000);
+	// Set a load value. After the timer reaches zero, reset the timer to 50000*period time by default.
+	TimerLoadSet( TIMER0_BASE, TIMER_A, ConfigGet( CFG_TIMER_LOAD ));
 
 	//Enable Timer_0_A interrupt in the peripheral
 	TimerIntEnable( TIMER0_BASE, TIMER_TIMA_TIMEOUT );
@@ -168,11 +208,9 @@ extern void Task_TimeOfDay(void *pvParameters){
 	char				TimeString[32];
 
 	//
-	//	Initialize the OLED display and write status.
+	//	The compositor owns the OLED; this task only posts the clock pane.
 	//
-	RIT128x96x4Init(1000000);
-	RIT128x96x4Clear();
-	RIT128x96x4StringDraw("Timer_Interrupt", 8, 0, 8);
+	DisplayText(DISPLAY_TITLE, " Timer_Interrupt");
 
 	// The integer that will hold the number of interrupt ticks
 	long TimerStatus_1 = 0;
@@ -183,7 +221,9 @@ extern void Task_TimeOfDay(void *pvParameters){
 	while(1){
 
 		// Wait here until the semaphore is freed up
+		TRACE_BEGIN( TRACE_SPAN_TAKE );
 		xSemaphoreTake( Timer_0_A_Semaphore, portMAX_DELAY );
+		TRACE_END( TRACE_SPAN_TAKE );
 
 		// Increment cSeconds every time the semaphore is released. This should effectively keep the two counters in sync.
 		// This is mostly deprecated, from Experiment 1. It's still used for the display, but the interrupt counter
@@ -203,18 +243,14 @@ extern void Task_TimeOfDay(void *pvParameters){
 		}
 
 		
-		// Print all the time values to teh LED screen
-		sprintf(TimeString, "Time: %d", hours);
-		RIT128x96x4StringDraw(TimeString, 0, 16, 15);
-		sprintf(TimeString, ":%d", minutes);
-		RIT128x96x4StringDraw(TimeString, 48, 16, 15);
-		sprintf(TimeString, ":%d", seconds);
-		RIT128x96x4StringDraw(TimeString, 68, 16, 15);
-		sprintf(TimeString, ":%d", cSeconds);
-		RIT128x96x4StringDraw(TimeString, 88, 16, 15);
-
-		// Wait prevents this task from 
-		vTaskDelay(10);
+		// Post the time to the clock pane. Every tick posts, but the compositor only
+		// draws the newest value once per frame, and only the digits that changed.
+		usnprintf(TimeString, sizeof(TimeString), "Time: %d:%02d:%02d.%02d", hours, minutes, seconds, cSeconds);
+		DisplayText(DISPLAY_CLOCK, TimeString);
+
+		// Done with this tick. The semaphore alone paces the task; a delay here would
+		// push every job past the next interrupt and the clock would lose ticks.
+		DeadlineComplete(&TimeOfDayDeadline);
 	}
 }
 
@@ -224,6 +260,12 @@ extern void Task_TimeOfDay(void *pvParameters){
 __interrupt void Timer_0_A_ISR_Handler() {
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
+	TRACE_ISR_ENTER( TRACE_ISR_TIMER_0_A );
+	CAPTURE_EVENT( CAPTURE_ISR, CAPTURE_ISR_TIMER_0_A, 0 );
+
+	// Start of a Task_TimeOfDay job. Counted as lost if the last one has not finished.
+	DeadlineRelease( &TimeOfDayDeadline );
+
 	// increments the counter using the timer's hardware interrupt
 	TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
 	TimerCount++;
@@ -232,7 +274,10 @@ __interrupt void Timer_0_A_ISR_Handler() {
 	//
 	// "Give" the Timer_0_A_Semaphore
 	// This releases the semaphore so that other tasks can pick it up
+	TRACE_MARK( TRACE_MARK_GIVE );
 	xSemaphoreGiveFromISR( Timer_0_A_Semaphore, &xHigherPriorityTaskWoken );
+
+	TRACE_ISR_EXIT( TRACE_ISR_TIMER_0_A );
 	//
 	// If xHigherPriorityTaskWoken was set to true,
 	// we should yield. The actual macro used here is
@@ -246,6 +291,17 @@ __interrupt void Timer_0_A_ISR_Handler() {
 }
 
 
+//*****************************************************************************
+//
+//	Idle hook (configUSE_IDLE_HOOK 1). The governor sleeps here and measures
+//	the CPU load from the time spent asleep.
+//
+//*****************************************************************************
+
+void vApplicationIdleHook(void){
+	GovernorIdle();
+}
+
 //*****************************************************************************
 //
 //	Main
@@ -254,22 +310,45 @@ __interrupt void Timer_0_A_ISR_Handler() {
 
 int main(void) {
 
+    //
+    // Load the stored configuration and calibration values. The clock divisor comes from here.
+    //
+    ConfigInit();
+
     //
     // Set the clocking to run directly from the crystal.
     //
-    SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ);
+    SysCtlClockSet(CONFIG_SYSCTL_SYSDIV(ConfigGet(CFG_SYSDIV)) | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ);
+
+#ifdef CAPTURE_ENABLE
+	// Record the first Timer_0_A interrupts for replay. Dumped by the Uart task.
+	CaptureStart();
+#endif
 
-    xTaskCreate(Uart, (signed portCHAR*) "Uart", 32, NULL, 1, NULL);
+	//
+	//	The display compositor takes over the OLED. Other tasks post pane updates to it.
+	//
+	DisplayInit(DISPLAY_TASK_PRIORITY, DISPLAY_TASK_PERIOD_MS);
+
+	//
+	//	Clock scaling. Slows the clock while the load and the deadlines allow it.
+	//
+	GovernorInit(GOVERNOR_TASK_PRIORITY, GOVERNOR_TASK_PERIOD_MS, TASKSET_SYSDIV_MAX);
+
+	//
+	//	Priorities are rate monotonic, see TaskSet.h. The Uart stack is sized for the deadline report.
+	//
+    xTaskCreate(Uart, (signed portCHAR*) "Uart", 128, NULL, UART_TASK_PRIORITY, NULL);
 
 	//
-	//	Create a task to blink LED
+	//	Create a task to blink LED. The stack is sized for the deadline calls and vTaskDelayUntil().
 	//
-	xTaskCreate(BlinkLED, (signed portCHAR*) "Blinky", 32, NULL, 1, NULL);
+	xTaskCreate(BlinkLED, (signed portCHAR*) "Blinky", 128, NULL, BLINKY_TASK_PRIORITY, NULL);
 
 
 
 	//RUNS EXPERIMENT TASK
-	xTaskCreate(Task_TimeOfDay, (signed portCHAR*) "Task_TimeOfDay", 512, NULL, 1, NULL);
+	xTaskCreate(Task_TimeOfDay, (signed portCHAR*) "Task_TimeOfDay", 512, NULL, TIMEOFDAY_TASK_PRIORITY, NULL);
 
 
 
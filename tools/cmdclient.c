@@ -0,0 +1,307 @@
+//*****************************************************************************
+//
+//	cmdclient.c
+//
+//		Host side client for the UART0 command protocol
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Send commands to the lab 6 firmware over a serial port
+//						(or a pty) and print the replies. The bench command
+//						measures round trip latency and throughput, and the
+//						time the same frames take at 115200 baud; over a pty
+//						there is no baud rate, so only the second is the wire.
+//
+//		Build:			cc -O2 -o cmdclient cmdclient.c
+//
+//		Usage:			cmdclient <device> ping
+//						cmdclient <device> get <param>
+//						cmdclient <device> set <param> <value>
+//						cmdclient <device> start | stop | stats
+//						cmdclient <device> capture | dump > capture.log
+//						cmdclient <device> deadlines > deadline.log
+//						cmdclient <device> trace > trace.log
+//						cmdclient <device> bench [count]
+//
+//*****************************************************************************
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../lab 6 sensor/Command.h"
+
+#define REPLY_TIMEOUT_MS		500
+#define WIRE_BAUD				115200
+#define WIRE_BITS_PER_BYTE		10		// 8N1: start, 8 data, stop
+
+static const char *g_ppcStatNames[] =
+{
+	"pings", "last_echo", "frames_ok", "frames_bad", "rx_overruns", "deadline_miss", "stream_skipped"
+};
+
+static double Now( void ) {
+	struct timespec sTime;
+
+	clock_gettime( CLOCK_MONOTONIC, &sTime );
+	return sTime.tv_sec + sTime.tv_nsec / 1e9;
+}
+
+static int OpenPort( const char *pcDevice ) {
+	struct termios sTio;
+	int iFd;
+
+	iFd = open( pcDevice, O_RDWR | O_NOCTTY );
+	if ( iFd < 0 ) {
+		fprintf( stderr, "cmdclient: %s: %s\n", pcDevice, strerror( errno ) );
+		return -1;
+	}
+
+	// Matches UARTStdioInit(): 115200 8N1, no flow control. Ignored on a pty.
+	if ( tcgetattr( iFd, &sTio ) == 0 ) {
+		cfmakeraw( &sTio );
+		cfsetispeed( &sTio, B115200 );
+		cfsetospeed( &sTio, B115200 );
+		sTio.c_cflag |= CLOCAL | CREAD;
+		tcsetattr( iFd, TCSANOW, &sTio );
+	}
+	tcflush( iFd, TCIOFLUSH );
+	return iFd;
+}
+
+static int SendFrame( int iFd, unsigned char ucCmd, const unsigned char *pucData, unsigned char ucLen ) {
+	unsigned char pucFrame[CMD_MAX_PAYLOAD + 4];
+	unsigned char ucSum;
+	int iIdx;
+
+	pucFrame[0] = CMD_SOF;
+	pucFrame[1] = ucCmd;
+	pucFrame[2] = ucLen;
+	ucSum = ucCmd + ucLen;
+	for ( iIdx = 0; iIdx < ucLen; iIdx++ ) {
+		pucFrame[3 + iIdx] = pucData[iIdx];
+		ucSum += pucData[iIdx];
+	}
+	pucFrame[3 + ucLen] = -ucSum;
+
+	return write( iFd, pucFrame, ucLen + 4 ) == ucLen + 4 ? 0 : -1;
+}
+
+static int ReadByte( int iFd, unsigned char *pucByte ) {
+	struct pollfd sPoll = { iFd, POLLIN, 0 };
+
+	if ( poll( &sPoll, 1, REPLY_TIMEOUT_MS ) <= 0 ) {
+		return -1;
+	}
+	return read( iFd, pucByte, 1 ) == 1 ? 0 : -1;
+}
+
+//*****************************************************************************
+//
+//	Wait for the reply to ucCmd. Streamed text lines and frames that fail
+//	their checksum are skipped; text is copied to pEcho if it is not null.
+//	Returns the payload length (status included) or -1 on timeout.
+//
+//*****************************************************************************
+static int ReadReply( int iFd, unsigned char ucCmd, unsigned char *pucData, FILE *pEcho ) {
+	unsigned char ucByte, ucLen, ucSum, ucRxCmd;
+	int iIdx;
+
+	while ( 1 ) {
+		do {
+			if ( ReadByte( iFd, &ucByte ) ) {
+				return -1;
+			}
+			if ( pEcho && ucByte != CMD_SOF ) {
+				fputc( ucByte, pEcho );
+			}
+		} while ( ucByte != CMD_SOF );
+
+		if ( ReadByte( iFd, &ucRxCmd ) || ReadByte( iFd, &ucLen ) || ucLen > CMD_MAX_PAYLOAD + 1 ) {
+			continue;
+		}
+		ucSum = ucRxCmd + ucLen;
+		for ( iIdx = 0; iIdx < ucLen; iIdx++ ) {
+			if ( ReadByte( iFd, &pucData[iIdx] ) ) {
+				return -1;
+			}
+			ucSum += pucData[iIdx];
+		}
+		if ( ReadByte( iFd, &ucByte ) || (unsigned char)( ucSum + ucByte ) != 0 ) {
+			continue;
+		}
+		if ( ucRxCmd == ( ucCmd | CMD_RESPONSE ) && ucLen > 0 ) {
+			return ucLen;
+		}
+	}
+}
+
+static unsigned long GetLong( const unsigned char *pucData ) {
+	return pucData[0] | ( pucData[1] << 8 ) | ( pucData[2] << 16 ) | ( (unsigned long)pucData[3] << 24 );
+}
+
+static int Transact( int iFd, unsigned char ucCmd, const unsigned char *pucData,
+					 unsigned char ucLen, unsigned char *pucReply, FILE *pEcho ) {
+	int iLen;
+
+	if ( SendFrame( iFd, ucCmd, pucData, ucLen ) ) {
+		fprintf( stderr, "cmdclient: write failed\n" );
+		return -1;
+	}
+	iLen = ReadReply( iFd, ucCmd, pucReply, pEcho );
+	if ( iLen < 0 ) {
+		fprintf( stderr, "cmdclient: no reply\n" );
+		return -1;
+	}
+	if ( pucReply[0] != CMD_OK ) {
+		fprintf( stderr, "cmdclient: error status 0x%02x\n", pucReply[0] );
+		return -1;
+	}
+	return iLen;
+}
+
+//*****************************************************************************
+//
+//	Round trip a full size CMD_PING count times and report latency and the
+//	payload throughput in both directions. The last line is the time the
+//	frames alone take at WIRE_BAUD, which bounds both on the board.
+//
+//*****************************************************************************
+static int Bench( int iFd, int iCount ) {
+	unsigned char pucData[CMD_MAX_PAYLOAD];
+	unsigned char pucReply[CMD_MAX_PAYLOAD + 1];
+	double dStart, dTotal, dRtt, dMin = 1e9, dMax = 0, dWire;
+	int iIdx, iByte;
+
+	dWire = ( 2.0 * CMD_MAX_PAYLOAD + 9 ) * WIRE_BITS_PER_BYTE / WIRE_BAUD;
+	dStart = Now();
+	for ( iIdx = 0; iIdx < iCount; iIdx++ ) {
+		for ( iByte = 0; iByte < CMD_MAX_PAYLOAD; iByte++ ) {
+			pucData[iByte] = iIdx + iByte;
+		}
+		dRtt = Now();
+		if ( Transact( iFd, CMD_PING, pucData, CMD_MAX_PAYLOAD, pucReply, 0 ) != CMD_MAX_PAYLOAD + 1 ||
+			 memcmp( pucData, &pucReply[1], CMD_MAX_PAYLOAD ) ) {
+			fprintf( stderr, "cmdclient: bad echo on round trip %d\n", iIdx );
+			return 1;
+		}
+		dRtt = Now() - dRtt;
+		dMin = dRtt < dMin ? dRtt : dMin;
+		dMax = dRtt > dMax ? dRtt : dMax;
+	}
+	dTotal = Now() - dStart;
+
+	printf( "round trips: %d\n", iCount );
+	printf( "latency ms:  min %.3f  avg %.3f  max %.3f\n",
+			dMin * 1e3, dTotal * 1e3 / iCount, dMax * 1e3 );
+	printf( "throughput:  %.0f payload bytes/s each way, %.0f frame bytes/s total\n",
+			iCount * CMD_MAX_PAYLOAD / dTotal,
+			iCount * ( 2.0 * CMD_MAX_PAYLOAD + 9 ) / dTotal );
+	printf( "%d baud:  %.3f ms per round trip, %.0f payload bytes/s each way\n",
+			WIRE_BAUD, dWire * 1e3, CMD_MAX_PAYLOAD / dWire );
+	return 0;
+}
+
+int main( int argc, char **argv ) {
+	unsigned char pucData[CMD_MAX_PAYLOAD];
+	unsigned char pucReply[CMD_MAX_PAYLOAD + 1];
+	unsigned long ulValue;
+	int iFd, iLen, iIdx;
+
+	if ( argc < 3 ) {
+		fprintf( stderr, "usage: %s <device> ping|get|set|start|stop|stats|capture|dump|deadlines|trace|bench ...\n", argv[0] );
+		return 2;
+	}
+	iFd = OpenPort( argv[1] );
+	if ( iFd < 0 ) {
+		return 1;
+	}
+
+	if ( !strcmp( argv[2], "ping" ) ) {
+		if ( Transact( iFd, CMD_PING, 0, 0, pucReply, 0 ) < 0 ) {
+			return 1;
+		}
+		printf( "ok\n" );
+	}
+	else if ( !strcmp( argv[2], "get" ) && argc == 4 ) {
+		pucData[0] = atoi( argv[3] );
+		if ( Transact( iFd, CMD_GET, pucData, 1, pucReply, 0 ) != 6 ) {
+			return 1;
+		}
+		printf( "%u = %lu\n", pucReply[1], GetLong( &pucReply[2] ) );
+	}
+	else if ( !strcmp( argv[2], "set" ) && argc == 5 ) {
+		ulValue = strtoul( argv[4], 0, 0 );
+		pucData[0] = atoi( argv[3] );
+		pucData[1] = ulValue;
+		pucData[2] = ulValue >> 8;
+		pucData[3] = ulValue >> 16;
+		pucData[4] = ulValue >> 24;
+		if ( Transact( iFd, CMD_SET, pucData, 5, pucReply, 0 ) != 6 ) {
+			return 1;
+		}
+		printf( "%u = %lu\n", pucReply[1], GetLong( &pucReply[2] ) );
+	}
+	else if ( !strcmp( argv[2], "start" ) || !strcmp( argv[2], "stop" ) ) {
+		if ( Transact( iFd, argv[2][2] == 'a' ? CMD_STREAM_START : CMD_STREAM_STOP, 0, 0, pucReply, 0 ) < 0 ) {
+			return 1;
+		}
+		printf( "ok\n" );
+	}
+	else if ( !strcmp( argv[2], "stats" ) ) {
+		iLen = Transact( iFd, CMD_STATS, 0, 0, pucReply, 0 );
+		if ( iLen < 0 ) {
+			return 1;
+		}
+		for ( iIdx = 0; iIdx * 4 + 4 < iLen; iIdx++ ) {
+			printf( "%-12s %lu\n",
+					iIdx < (int)( sizeof( g_ppcStatNames ) / sizeof( g_ppcStatNames[0] ) ) ? g_ppcStatNames[iIdx] : "?",
+					GetLong( &pucReply[1 + iIdx * 4] ) );
+		}
+	}
+	else if ( !strcmp( argv[2], "capture" ) ) {
+		if ( Transact( iFd, CMD_CAPTURE_START, 0, 0, pucReply, 0 ) < 0 ) {
+			return 1;
+		}
+		printf( "ok\n" );
+	}
+	else if ( !strcmp( argv[2], "dump" ) ) {
+		// The dump is printed before the reply; pass it, and any streamed lines, to stdout.
+		if ( Transact( iFd, CMD_CAPTURE_DUMP, 0, 0, pucReply, stdout ) < 0 ) {
+			return 1;
+		}
+	}
+	else if ( !strcmp( argv[2], "deadlines" ) ) {
+		// Same as dump: the "deadline:" lines for tools/rmsched come before the reply.
+		if ( Transact( iFd, CMD_DEADLINES, 0, 0, pucReply, stdout ) < 0 ) {
+			return 1;
+		}
+	}
+	else if ( !strcmp( argv[2], "trace" ) ) {
+		// The "trace:" lines for tools/trace2json come before the reply.
+		if ( Transact( iFd, CMD_TRACE_DUMP, 0, 0, pucReply, stdout ) < 0 ) {
+			return 1;
+		}
+	}
+	else if ( !strcmp( argv[2], "bench" ) ) {
+		iLen = argc > 3 ? atoi( argv[3] ) : 100;
+		if ( iLen < 1 ) {
+			fprintf( stderr, "cmdclient: bench needs a count of at least 1\n" );
+			return 2;
+		}
+		return Bench( iFd, iLen );
+	}
+	else {
+		fprintf( stderr, "cmdclient: unknown command %s\n", argv[2] );
+		return 2;
+	}
+
+	close( iFd );
+	return 0;
+}
@@ -0,0 +1,128 @@
+//*****************************************************************************
+//
+//	Replay.h
+//
+//		Replay engine shared by replay.c and ReplayShim.c
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//*****************************************************************************
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include "../../common/Capture.h"
+
+#define REPLAY_ROWS				12		// 96 pixel rows / 8
+#define REPLAY_COLUMNS			21		// 128 pixel columns / 6
+
+//*****************************************************************************
+//
+//	What the replayed code did, filled in by the stand-ins
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned long	ulEvents;			// Capture events consumed
+	unsigned long	ulInterrupts;		// ISRs delivered
+	unsigned long	ulLostGives;		// Semaphore gives that found it already given
+	unsigned long	ulDesyncs;			// Code and capture disagreed about the next input
+	unsigned long	ulUartLines;		// Lines printed with UARTprintf()
+	unsigned long	ulOledChars;		// Characters drawn on the OLED
+	unsigned long	ulSsiBytes;			// Bytes the OLED driver would send over SSI
+	int				bVerbose;			// Echo UARTprintf() output
+	int				bHostTime;			// SysTick counts host time within each tick
+	char			ppcScreen[REPLAY_ROWS][REPLAY_COLUMNS + 1];
+} tReplayStats;
+
+extern tReplayStats g_sReplay;
+
+//*****************************************************************************
+//
+//	Clock and peripheral set up as the stand-ins last saw it. The registers
+//	are what HWREG() reads and writes.
+//
+//*****************************************************************************
+typedef struct
+{
+	volatile unsigned int	uiRcc;				// SYSCTL_RCC; SysCtlClockGet() decodes SYSDIV
+	volatile unsigned int	uiSysTickReload;	// NVIC_ST_RELOAD
+	unsigned long			ulTimerLoad;		// Timer_0_A
+	unsigned long			ulTimerPrescale;
+	unsigned long			ulUartClock;		// UART0, as given to UARTConfigSetExpClk()
+	unsigned long			ulUartBaud;
+	unsigned long			ulSsiClock;			// SSI0, as given to SSIConfigSetExpClk()
+	unsigned long			ulSsiBitRate;
+	unsigned long			ulSleeps;			// SysCtlSleep() calls
+} tReplayHardware;
+
+extern tReplayHardware g_sHardware;
+
+//*****************************************************************************
+//
+//	RAM model of the top REPLAY_FLASH_SIZE bytes of flash, where the config
+//	store lives. Programming only clears bits and erasing sets a whole page.
+//	The rest of flash reads as blank.
+//
+//	Setting ulCutAt cuts the power at that write, counting word programs and
+//	page erases together from ulWrites. The cut write is left part done,
+//	with each bit it would change changed at the same random chance, and
+//	pfnCut is called in place of returning. pfnCut must not return.
+//
+//*****************************************************************************
+#define REPLAY_FLASH_BASE		0x0003F000
+#define REPLAY_FLASH_SIZE		0x1000
+#define REPLAY_FLASH_PAGE		1024
+
+typedef struct
+{
+	unsigned int	puiWords[REPLAY_FLASH_SIZE / 4];
+	unsigned long	ulWrites;			// Words programmed plus pages erased
+	unsigned long	ulErases;			// Pages erased
+	unsigned long	ulReads;			// Words read through HWREG()
+	unsigned long	ulClocks;			// Last FlashUsecSet() value
+	unsigned long	ulCutAt;			// Write to cut the power at, 0 for none
+	void			( *pfnCut )( void );
+} tReplayFlash;
+
+extern tReplayFlash g_sFlash;
+
+//*****************************************************************************
+//
+//	Erase the whole flash model. Call before the first ConfigInit().
+//
+//*****************************************************************************
+extern void ReplayFlashBlank( void );
+
+//*****************************************************************************
+//
+//	Run pfnTask until it asks for an input past the end of the capture.
+//
+//*****************************************************************************
+extern void ReplayRun( const tCaptureEvent *psEvents, unsigned long ulCount,
+					   void ( *pfnTask )( void * ), const char *pcName );
+
+//*****************************************************************************
+//
+//	Call pfnFunc every ulPeriod ticks of replayed time, whenever the task is
+//	blocked. Stands in for a lower priority periodic task named pcName.
+//
+//*****************************************************************************
+extern void ReplayBackground( void ( *pfnFunc )( void ), unsigned long ulPeriod, const char *pcName );
+
+//*****************************************************************************
+//
+//	The task function a name was given to xTaskCreate() with, or null.
+//
+//*****************************************************************************
+extern pdTASK_CODE ReplayTask( const char *pcName );
+
+//*****************************************************************************
+//
+//	Open a pty, print its slave name on stdout and run pfnTask with UART0 on
+//	the pty until reading it fails. Returns -1 if no pty could be opened.
+//
+//*****************************************************************************
+extern int ReplayServe( void ( *pfnTask )( void * ), const char *pcName );
+
+#endif // __REPLAY_H__
@@ -0,0 +1,945 @@
+//*****************************************************************************
+//
+//	ReplayShim.c
+//
+//		Host stand-ins for the StellarisWare and FreeRTOS calls, fed from a
+//		capture
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Notes:			The lab code asks for its inputs in the same order it
+//						did when the capture was taken:
+//
+//						GPIOPinRead() on the PING line returns the level of
+//						the next CAPTURE_EDGE, TimerValueGet() the value of the
+//						next CAPTURE_TIMER, and the start of a PING pulse
+//						consumes the CAPTURE_PING. Each input taken moves the
+//						tick up to the one it was captured in, so a job spans
+//						the ticks it did on the target. CAPTURE_ISR events are
+//						delivered by calling the real handler whenever the
+//						code blocks or looks for its next input, and
+//						vTaskDelay() and vTaskDelayUntil() deliver the ones
+//						due before they return.
+//
+//						Nothing waits in real time, so a capture replays as
+//						fast as the host runs the code. Work registered with
+//						ReplayBackground() runs while the task is blocked, as
+//						a lower priority task would.
+//
+//						Switches between the task, the background work and
+//						idle go to Trace.c as the kernel hook would report
+//						them. SysTick reads as the top of the tick, just past
+//						the SysTick interrupt, unless bHostTime is set, when
+//						it counts down with host time since the tick started,
+//						so spans get host durations.
+//
+//						ReplayServe() runs a task against a pty instead of a
+//						capture. UART0 is the pty: bytes written to it arrive
+//						in the RX FIFO up to 16 at a time and raise the
+//						handler given to UARTIntRegister(), and UART0 output
+//						goes back out. Ticks are host milliseconds.
+//
+//*****************************************************************************
+
+#define _XOPEN_SOURCE			600
+
+#include <fcntl.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shim/ReplayShim.h"
+#include "../../common/Trace.h"
+#include "Replay.h"
+
+//*****************************************************************************
+//
+//	GPIOPinRead() calls allowed without the capture moving before the next
+//	event is treated as a desync and skipped.
+//
+//*****************************************************************************
+#define REPLAY_MAX_POLLS		100000
+
+//*****************************************************************************
+//
+//	Depth of the UART0 RX FIFO, and of the buffer UART0 output collects in
+//	before it is written to the pty.
+//
+//*****************************************************************************
+#define REPLAY_UART_FIFO		16
+#define REPLAY_UART_TX_BUFFER	4096
+
+#define REPLAY_TASKS			8
+
+//*****************************************************************************
+//
+//	SysTick counts taken by the SysTick interrupt itself. Code at the top of a
+//	tick reads this far below the reload, as it would on the target, so
+//	Trace.c does not take it for a wrap not yet counted.
+//
+//*****************************************************************************
+#define REPLAY_SYSTICK_ISR		100
+
+extern void Timer_0_A_ISR_Handler( void );
+
+volatile int long xPortSysTickCount;
+
+tReplayStats g_sReplay;
+
+// Reset state: 50 MHz, SysTick at configTICK_RATE_HZ.
+tReplayHardware g_sHardware = { SYSCTL_SYSDIV_4, 50000000 / configTICK_RATE_HZ - 1 };
+
+tReplayFlash g_sFlash;
+
+static const tCaptureEvent *g_psEvents;
+static unsigned long g_ulCount;
+static unsigned long g_ulNext;
+static unsigned long g_ulLevel;
+static unsigned long g_ulTimer;
+static unsigned long g_ulPolls;
+static jmp_buf g_sEnd;
+
+static tReplaySemaphore g_psSemaphores[8];
+static unsigned long g_ulSemaphores;
+
+static void ( *g_pfnBackground )( void );
+static unsigned long g_ulBackgroundPeriod;
+static unsigned long g_ulBackgroundNext;
+
+// Which context is running, for the trace. The name doubles as the handle.
+static const char g_pcIdle[] = "IDLE";
+static const char *g_pcTaskName;
+static const char *g_pcBackgroundName;
+static const char *g_pcRunning;
+
+static struct timespec g_sTickStart;
+
+// Tasks handed to xTaskCreate(), so a static task function can be served.
+static struct
+{
+	pdTASK_CODE	pfnTask;
+	const char	*pcName;
+} g_psTasks[REPLAY_TASKS];
+static unsigned long g_ulTasks;
+
+// UART0 when serving a pty; g_iUartFd is -1 otherwise.
+static int g_iUartFd = -1;
+static void ( *g_pfnUartHandler )( void );
+static unsigned char g_pucUartRx[REPLAY_UART_FIFO];
+static unsigned long g_ulUartRxHead;
+static unsigned long g_ulUartRxCount;
+static unsigned char g_pucUartTx[REPLAY_UART_TX_BUFFER];
+static unsigned long g_ulUartTxCount;
+static struct timespec g_sServeStart;
+
+static void ReplayFinish( void ) {
+	g_sReplay.ulEvents = g_ulNext;
+	longjmp( g_sEnd, 1 );
+}
+
+static void ReplaySetTick( unsigned long ulTick ) {
+	if ( (long)( ulTick - xPortSysTickCount ) > 0 ) {
+		xPortSysTickCount = ulTick;
+		clock_gettime( CLOCK_MONOTONIC, &g_sTickStart );
+	}
+}
+
+static void ReplaySwitch( const char *pcName ) {
+	if ( pcName != g_pcRunning ) {
+		g_pcRunning = pcName;
+		TRACE_TASK_SWITCHED_IN( pcName );
+	}
+}
+
+//
+// SysTick counts since the tick started, in host time, capped at one tick.
+//
+static unsigned long ReplayHostCounts( void ) {
+	struct timespec sNow;
+	double dCounts;
+
+	if ( !g_sReplay.bHostTime ) {
+		return 0;
+	}
+	clock_gettime( CLOCK_MONOTONIC, &sNow );
+	dCounts = ( ( sNow.tv_sec - g_sTickStart.tv_sec ) + ( sNow.tv_nsec - g_sTickStart.tv_nsec ) / 1e9 ) *
+			  SysCtlClockGet();
+	return dCounts < g_sHardware.uiSysTickReload ? (unsigned long)dCounts : g_sHardware.uiSysTickReload;
+}
+
+//*****************************************************************************
+//
+//	The task is blocked until ulTick. Run the background work due by then.
+//
+//*****************************************************************************
+static void ReplayBlocked( unsigned long ulTick ) {
+	ReplaySwitch( g_pcIdle );
+	while ( g_pfnBackground && (long)( g_ulBackgroundNext - ulTick ) <= 0 ) {
+		ReplaySetTick( g_ulBackgroundNext );
+		g_ulBackgroundNext += g_ulBackgroundPeriod;
+		ReplaySwitch( g_pcBackgroundName );
+		g_pfnBackground();
+		ReplaySwitch( g_pcIdle );
+	}
+}
+
+//*****************************************************************************
+//
+//	Run the handler for the CAPTURE_ISR event at the head of the capture.
+//
+//*****************************************************************************
+static void ReplayInterrupt( void ) {
+	const tCaptureEvent *psEvent = &g_psEvents[g_ulNext++];
+
+	ReplaySetTick( psEvent->ulTick );
+	g_sReplay.ulInterrupts++;
+	if ( psEvent->ucValue == CAPTURE_ISR_TIMER_0_A ) {
+		Timer_0_A_ISR_Handler();
+	}
+}
+
+//*****************************************************************************
+//
+//	Deliver the interrupts at the head of the capture and return the next
+//	event the code has to ask for. Ends the replay if there is none.
+//
+//*****************************************************************************
+static const tCaptureEvent *ReplayPeek( void ) {
+	while ( g_ulNext < g_ulCount && g_psEvents[g_ulNext].ucType == CAPTURE_ISR ) {
+		ReplayInterrupt();
+	}
+	if ( g_ulNext >= g_ulCount ) {
+		ReplayFinish();
+	}
+	return &g_psEvents[g_ulNext];
+}
+
+static void ReplayDesync( void ) {
+	g_sReplay.ulDesyncs++;
+	g_ulNext++;
+	g_ulPolls = 0;
+}
+
+void ReplayRun( const tCaptureEvent *psEvents, unsigned long ulCount,
+				void ( *pfnTask )( void * ), const char *pcName ) {
+	unsigned long ulIdx;
+
+	g_psEvents = psEvents;
+	g_ulCount = ulCount;
+	g_ulNext = 0;
+	g_ulLevel = 0;
+	g_ulTimer = 0;
+	g_ulPolls = 0;
+	xPortSysTickCount = ulCount ? psEvents[0].ulTick : 0;
+	g_ulBackgroundNext = xPortSysTickCount + g_ulBackgroundPeriod;
+	clock_gettime( CLOCK_MONOTONIC, &g_sTickStart );
+	g_pcTaskName = pcName;
+	g_pcRunning = 0;
+
+	// A previous run may have ended with a lock held.
+	for ( ulIdx = 0; ulIdx < 8; ulIdx++ ) {
+		g_psSemaphores[ulIdx].iGiven = 1;
+	}
+
+	if ( setjmp( g_sEnd ) == 0 ) {
+		ReplaySwitch( g_pcTaskName );
+		pfnTask( NULL );
+	}
+}
+
+void ReplayBackground( void ( *pfnFunc )( void ), unsigned long ulPeriod, const char *pcName ) {
+	g_pfnBackground = pfnFunc;
+	g_ulBackgroundPeriod = ulPeriod;
+	g_pcBackgroundName = pcName;
+}
+
+pdTASK_CODE ReplayTask( const char *pcName ) {
+	unsigned long ulIdx;
+
+	for ( ulIdx = 0; ulIdx < g_ulTasks; ulIdx++ ) {
+		if ( !strcmp( g_psTasks[ulIdx].pcName, pcName ) ) {
+			return g_psTasks[ulIdx].pfnTask;
+		}
+	}
+	return 0;
+}
+
+//*****************************************************************************
+//
+//	Write out what UART0 has sent since the last flush.
+//
+//*****************************************************************************
+static void ReplayUartFlush( void ) {
+	unsigned long ulDone = 0;
+	ssize_t iWritten;
+
+	while ( ulDone < g_ulUartTxCount ) {
+		iWritten = write( g_iUartFd, &g_pucUartTx[ulDone], g_ulUartTxCount - ulDone );
+		if ( iWritten <= 0 ) {
+			break;
+		}
+		ulDone += iWritten;
+	}
+	g_ulUartTxCount = 0;
+}
+
+static void ReplayUartSend( unsigned char ucData ) {
+	if ( g_ulUartTxCount == REPLAY_UART_TX_BUFFER ) {
+		ReplayUartFlush();
+	}
+	g_pucUartTx[g_ulUartTxCount++] = ucData;
+}
+
+//*****************************************************************************
+//
+//	The task is blocked on UART0 input. Send what it has written, wait for the
+//	next bytes from the pty and run the UART0 handler on them.
+//
+//*****************************************************************************
+static void ReplayUartReceive( void ) {
+	struct timespec sNow;
+	ssize_t iRead;
+
+	ReplayUartFlush();
+	ReplaySwitch( g_pcIdle );
+
+	iRead = read( g_iUartFd, g_pucUartRx, REPLAY_UART_FIFO );
+	if ( iRead <= 0 || !g_pfnUartHandler ) {
+		ReplayFinish();
+	}
+	g_ulUartRxHead = 0;
+	g_ulUartRxCount = iRead;
+
+	clock_gettime( CLOCK_MONOTONIC, &sNow );
+	ReplaySetTick( ( sNow.tv_sec - g_sServeStart.tv_sec ) * configTICK_RATE_HZ +
+				   ( sNow.tv_nsec - g_sServeStart.tv_nsec ) / ( 1000000000 / configTICK_RATE_HZ ) );
+	g_sReplay.ulInterrupts++;
+	g_pfnUartHandler();
+}
+
+int ReplayServe( void ( *pfnTask )( void * ), const char *pcName ) {
+	struct termios sTerm;
+	unsigned long ulIdx;
+	int iSlave;
+
+	g_iUartFd = posix_openpt( O_RDWR | O_NOCTTY );
+	if ( g_iUartFd < 0 || grantpt( g_iUartFd ) || unlockpt( g_iUartFd ) ) {
+		perror( "replay: pty" );
+		return -1;
+	}
+
+	// Hold the slave open so clients can come and go without a hangup, and
+	// make it raw so what UART0 sends is not echoed back as input.
+	iSlave = open( ptsname( g_iUartFd ), O_RDWR | O_NOCTTY );
+	if ( iSlave < 0 || tcgetattr( iSlave, &sTerm ) ) {
+		perror( "replay: pty" );
+		return -1;
+	}
+	sTerm.c_iflag &= ~( BRKINT | ICRNL | IGNCR | INLCR | ISTRIP | IXON );
+	sTerm.c_oflag &= ~OPOST;
+	sTerm.c_lflag &= ~( ECHO | ECHONL | ICANON | IEXTEN | ISIG );
+	tcsetattr( iSlave, TCSANOW, &sTerm );
+
+	printf( "%s\n", ptsname( g_iUartFd ) );
+	fflush( stdout );
+
+	g_ulCount = 0;
+	g_ulNext = 0;
+	xPortSysTickCount = 0;
+	g_sReplay.bHostTime = 1;
+	clock_gettime( CLOCK_MONOTONIC, &g_sServeStart );
+	g_sTickStart = g_sServeStart;
+	g_pcTaskName = pcName;
+	g_pcRunning = 0;
+	for ( ulIdx = 0; ulIdx < 8; ulIdx++ ) {
+		g_psSemaphores[ulIdx].iGiven = 1;
+	}
+
+	if ( setjmp( g_sEnd ) == 0 ) {
+		ReplaySwitch( g_pcTaskName );
+		pfnTask( NULL );
+	}
+
+	close( iSlave );
+	close( g_iUartFd );
+	g_iUartFd = -1;
+	return 0;
+}
+
+volatile unsigned int *ReplayRegister( unsigned long ulAddress ) {
+	static volatile unsigned int uiRegister;
+	unsigned long ulCounts;
+
+	switch ( ulAddress ) {
+	case SYSCTL_RCC:
+		return &g_sHardware.uiRcc;
+
+	case NVIC_ST_RELOAD:
+		return &g_sHardware.uiSysTickReload;
+
+	// SysTick sits at the top of each tick, just past its interrupt, with
+	// nothing pending, so Deadline.c measures whole ticks, unless host time
+	// is counted.
+	case NVIC_ST_CURRENT:
+		ulCounts = REPLAY_SYSTICK_ISR + ReplayHostCounts();
+		uiRegister = ulCounts < g_sHardware.uiSysTickReload ? g_sHardware.uiSysTickReload - ulCounts : 0;
+		break;
+
+	case NVIC_INT_CTRL:
+		uiRegister = 0;
+		break;
+
+	// The config store reads flash directly.
+	default:
+		if ( ulAddress >= REPLAY_FLASH_BASE && ulAddress < REPLAY_FLASH_BASE + REPLAY_FLASH_SIZE ) {
+			g_sFlash.ulReads++;
+			return &g_sFlash.puiWords[( ulAddress - REPLAY_FLASH_BASE ) / 4];
+		}
+
+		// Every peripheral clock is on, and the rest of flash is blank.
+		uiRegister = 0xFFFFFFFF;
+		break;
+	}
+	return &uiRegister;
+}
+
+//*****************************************************************************
+//
+//	sysctl.h
+//
+//*****************************************************************************
+void SysCtlPeripheralEnable( unsigned long ulPeripheral ) {
+}
+
+void SysCtlPeripheralDisable( unsigned long ulPeripheral ) {
+}
+
+void SysCtlPeripheralReset( unsigned long ulPeripheral ) {
+}
+
+//
+// Only the PLL with SYSDIV is modelled: 200 MHz / SYSDIV. SysTick follows
+// the clock, as the FreeRTOS port sets it up.
+//
+void SysCtlClockSet( unsigned long ulConfig ) {
+	g_sHardware.uiRcc = ulConfig;
+	g_sHardware.uiSysTickReload = SysCtlClockGet() / configTICK_RATE_HZ - 1;
+}
+
+unsigned long SysCtlClockGet( void ) {
+	return 200000000 / ( ( ( g_sHardware.uiRcc & SYSCTL_RCC_SYSDIV_M ) >> SYSCTL_RCC_SYSDIV_S ) + 1 );
+}
+
+void SysCtlDelay( unsigned long ulCount ) {
+}
+
+void SysCtlSleep( void ) {
+	g_sHardware.ulSleeps++;
+}
+
+//*****************************************************************************
+//
+//	gpio.h. Only the PING line on PortD<1> is fed from the capture.
+//
+//*****************************************************************************
+void GPIOPinTypeGPIOInput( unsigned long ulPort, unsigned char ucPins ) {
+}
+
+void GPIOPinTypeGPIOOutput( unsigned long ulPort, unsigned char ucPins ) {
+}
+
+void GPIOPinTypeUART( unsigned long ulPort, unsigned char ucPins ) {
+}
+
+void GPIOPadConfigSet( unsigned long ulPort, unsigned char ucPins,
+					   unsigned long ulStrength, unsigned long ulPadType ) {
+}
+
+long GPIOPinRead( unsigned long ulPort, unsigned char ucPins ) {
+	const tCaptureEvent *psEvent;
+
+	if ( ulPort != GPIO_PORTD_BASE || !( ucPins & GPIO_PIN_1 ) ) {
+		return 0;
+	}
+
+	psEvent = ReplayPeek();
+	if ( psEvent->ucType == CAPTURE_EDGE ) {
+		ReplaySetTick( psEvent->ulTick );
+		g_ulLevel = psEvent->ucValue;
+		g_ulNext++;
+		g_ulPolls = 0;
+	}
+	else if ( ++g_ulPolls > REPLAY_MAX_POLLS ) {
+		ReplayDesync();
+	}
+	return g_ulLevel ? ( ucPins & GPIO_PIN_1 ) : 0;
+}
+
+void GPIOPinWrite( unsigned long ulPort, unsigned char ucPins, unsigned char ucVal ) {
+	const tCaptureEvent *psEvent;
+
+	// Raising the PING line starts a measurement.
+	if ( ulPort == GPIO_PORTD_BASE && ( ucPins & ucVal & GPIO_PIN_1 ) ) {
+		psEvent = ReplayPeek();
+		if ( psEvent->ucType == CAPTURE_PING ) {
+			ReplaySetTick( psEvent->ulTick );
+			g_ulNext++;
+		}
+		else {
+			ReplayDesync();
+		}
+	}
+}
+
+//*****************************************************************************
+//
+//	timer.h
+//
+//*****************************************************************************
+void TimerConfigure( unsigned long ulBase, unsigned long ulConfig ) {
+}
+
+void TimerEnable( unsigned long ulBase, unsigned long ulTimer ) {
+}
+
+void TimerLoadSet( unsigned long ulBase, unsigned long ulTimer, unsigned long ulValue ) {
+	g_sHardware.ulTimerLoad = ulValue;
+}
+
+void TimerPrescaleSet( unsigned long ulBase, unsigned long ulTimer, unsigned long ulValue ) {
+	g_sHardware.ulTimerPrescale = ulValue;
+}
+
+unsigned long TimerPrescaleGet( unsigned long ulBase, unsigned long ulTimer ) {
+	return g_sHardware.ulTimerPrescale;
+}
+
+unsigned long TimerValueGet( unsigned long ulBase, unsigned long ulTimer ) {
+	const tCaptureEvent *psEvent;
+
+	psEvent = ReplayPeek();
+	if ( psEvent->ucType == CAPTURE_TIMER ) {
+		ReplaySetTick( psEvent->ulTick );
+		g_ulTimer = psEvent->usTimer;
+		g_ulNext++;
+	}
+	else {
+		g_sReplay.ulDesyncs++;
+	}
+	return g_ulTimer;
+}
+
+void TimerIntEnable( unsigned long ulBase, unsigned long ulIntFlags ) {
+}
+
+void TimerIntClear( unsigned long ulBase, unsigned long ulIntFlags ) {
+}
+
+//*****************************************************************************
+//
+//	interrupt.h
+//
+//*****************************************************************************
+void IntEnable( unsigned long ulInterrupt ) {
+}
+
+void IntPrioritySet( unsigned long ulInterrupt, unsigned char ucPriority ) {
+}
+
+tBoolean IntMasterDisable( void ) {
+	return false;
+}
+
+tBoolean IntMasterEnable( void ) {
+	return false;
+}
+
+//*****************************************************************************
+//
+//	cpu.h. Nothing is ever masked.
+//
+//*****************************************************************************
+unsigned long CPUcpsid( void ) {
+	return 0;
+}
+
+unsigned long CPUcpsie( void ) {
+	return 0;
+}
+
+//*****************************************************************************
+//
+//	uart.h, uartstdio.h. Nothing is received and output is discarded unless
+//	a pty is being served.
+//
+//*****************************************************************************
+void UARTIntRegister( unsigned long ulBase, void ( *pfnHandler )( void ) ) {
+	g_pfnUartHandler = pfnHandler;
+}
+
+void UARTIntEnable( unsigned long ulBase, unsigned long ulIntFlags ) {
+}
+
+void UARTIntClear( unsigned long ulBase, unsigned long ulIntFlags ) {
+}
+
+unsigned long UARTIntStatus( unsigned long ulBase, tBoolean bMasked ) {
+	return 0;
+}
+
+tBoolean UARTCharsAvail( unsigned long ulBase ) {
+	return g_ulUartRxHead < g_ulUartRxCount;
+}
+
+long UARTCharGetNonBlocking( unsigned long ulBase ) {
+	return g_ulUartRxHead < g_ulUartRxCount ? g_pucUartRx[g_ulUartRxHead++] : -1;
+}
+
+void UARTCharPut( unsigned long ulBase, unsigned char ucData ) {
+	if ( g_iUartFd >= 0 ) {
+		ReplayUartSend( ucData );
+	}
+}
+
+tBoolean UARTBusy( unsigned long ulBase ) {
+	return false;
+}
+
+void UARTConfigSetExpClk( unsigned long ulBase, unsigned long ulUARTClk,
+						  unsigned long ulBaud, unsigned long ulConfig ) {
+	g_sHardware.ulUartClock = ulUARTClk;
+	g_sHardware.ulUartBaud = ulBaud;
+}
+
+// uartstdio runs UART0 at 115200 baud from the current clock.
+void UARTStdioInit( unsigned long ulPort ) {
+	UARTConfigSetExpClk( UART0_BASE, SysCtlClockGet(), 115200,
+						 UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE );
+}
+
+void UARTprintf( const char *pcString, ... ) {
+	char pcLine[256];
+	char *pcChar;
+	va_list vaArgP;
+
+	if ( strchr( pcString, '\n' ) ) {
+		g_sReplay.ulUartLines++;
+	}
+	if ( g_iUartFd >= 0 ) {
+		// uartstdio sends "\r\n" for each newline.
+		va_start( vaArgP, pcString );
+		vsnprintf( pcLine, sizeof( pcLine ), pcString, vaArgP );
+		va_end( vaArgP );
+		for ( pcChar = pcLine; *pcChar; pcChar++ ) {
+			if ( *pcChar == '\n' ) {
+				ReplayUartSend( '\r' );
+			}
+			ReplayUartSend( *pcChar );
+		}
+	}
+	else if ( g_sReplay.bVerbose ) {
+		va_start( vaArgP, pcString );
+		vprintf( pcString, vaArgP );
+		va_end( vaArgP );
+	}
+}
+
+//
+// ustdlib.h. The lab code only uses the conversions the C library shares.
+//
+int usnprintf( char *pcBuf, unsigned long ulSize, const char *pcString, ... ) {
+	va_list vaArgP;
+	int iCount;
+
+	va_start( vaArgP, pcString );
+	iCount = vsnprintf( pcBuf, ulSize, pcString, vaArgP );
+	va_end( vaArgP );
+	return iCount;
+}
+
+//*****************************************************************************
+//
+//	ssi.h. Only the set up is recorded; the OLED traffic is counted below.
+//
+//*****************************************************************************
+void SSIConfigSetExpClk( unsigned long ulBase, unsigned long ulSSIClk,
+						 unsigned long ulProtocol, unsigned long ulMode,
+						 unsigned long ulBitRate, unsigned long ulDataWidth ) {
+	g_sHardware.ulSsiClock = ulSSIClk;
+	g_sHardware.ulSsiBitRate = ulBitRate;
+}
+
+void SSIEnable( unsigned long ulBase ) {
+}
+
+void SSIDisable( unsigned long ulBase ) {
+}
+
+tBoolean SSIBusy( unsigned long ulBase ) {
+	return false;
+}
+
+//*****************************************************************************
+//
+//	flash.h, on the RAM model in g_sFlash.
+//
+//*****************************************************************************
+void ReplayFlashBlank( void ) {
+	memset( g_sFlash.puiWords, 0xFF, sizeof( g_sFlash.puiWords ) );
+}
+
+static double ReplayChance( void ) {
+	return rand() / ( RAND_MAX + 1.0 );
+}
+
+//
+// Count one write. Returns how far it got: 1 if it completes, less if the
+// power is cut during it.
+//
+static double ReplayFlashWrite( void ) {
+	return ( ++g_sFlash.ulWrites == g_sFlash.ulCutAt ) ? ReplayChance() : 1.0;
+}
+
+//
+// The bits of uiBits that a write dDone of the way through has changed.
+//
+static unsigned int ReplayFlashTorn( unsigned int uiBits, double dDone ) {
+	unsigned int uiChanged = 0;
+	unsigned int uiBit;
+
+	for ( uiBit = 1; uiBit; uiBit <<= 1 ) {
+		if ( ( uiBits & uiBit ) && ReplayChance() < dDone ) {
+			uiChanged |= uiBit;
+		}
+	}
+	return uiChanged;
+}
+
+long FlashErase( unsigned long ulAddress ) {
+	unsigned long ulWord;
+	unsigned long ulIdx;
+	double dDone;
+
+	if ( ( ulAddress & ( REPLAY_FLASH_PAGE - 1 ) ) ||
+		 ulAddress < REPLAY_FLASH_BASE || ulAddress >= REPLAY_FLASH_BASE + REPLAY_FLASH_SIZE ) {
+		return -1;
+	}
+
+	dDone = ReplayFlashWrite();
+	ulWord = ( ulAddress - REPLAY_FLASH_BASE ) / 4;
+	for ( ulIdx = ulWord; ulIdx < ulWord + REPLAY_FLASH_PAGE / 4; ulIdx++ ) {
+		g_sFlash.puiWords[ulIdx] |= ( dDone < 1.0 ) ? ReplayFlashTorn( ~g_sFlash.puiWords[ulIdx], dDone ) : 0xFFFFFFFF;
+	}
+	g_sFlash.ulErases++;
+
+	if ( dDone < 1.0 ) {
+		g_sFlash.pfnCut();
+	}
+	return 0;
+}
+
+//
+// ulCount is in bytes of pulData, which holds one 32 bit word per element
+// as on the target.
+//
+long FlashProgram( unsigned long *pulData, unsigned long ulAddress, unsigned long ulCount ) {
+	unsigned long ulWords = ulCount / sizeof( *pulData );
+	unsigned long ulIdx;
+	unsigned int uiClear;
+	volatile unsigned int *puiWord;
+	double dDone;
+
+	if ( ( ulAddress & 3 ) || ( ulCount % sizeof( *pulData ) ) || ulAddress < REPLAY_FLASH_BASE ||
+		 ulAddress + ulWords * 4 > REPLAY_FLASH_BASE + REPLAY_FLASH_SIZE ) {
+		return -1;
+	}
+
+	for ( ulIdx = 0; ulIdx < ulWords; ulIdx++ ) {
+		puiWord = &g_sFlash.puiWords[( ulAddress - REPLAY_FLASH_BASE ) / 4 + ulIdx];
+		dDone = ReplayFlashWrite();
+		uiClear = *puiWord & ~(unsigned int)pulData[ulIdx];
+		*puiWord &= ~( ( dDone < 1.0 ) ? ReplayFlashTorn( uiClear, dDone ) : uiClear );
+
+		if ( dDone < 1.0 ) {
+			g_sFlash.pfnCut();
+		}
+	}
+	return 0;
+}
+
+void FlashUsecSet( unsigned long ulClocks ) {
+	g_sFlash.ulClocks = ulClocks;
+}
+
+//*****************************************************************************
+//
+//	rit128x96x4.h. Text goes into a character grid for the report. SSI bytes
+//	are counted as the StellarisWare driver sends them: window and mode
+//	commands, then 4 bits per pixel.
+//
+//*****************************************************************************
+// The driver sets SSI0 up for the panel from the current clock.
+void RIT128x96x4Init( unsigned long ulFrequency ) {
+	SSIConfigSetExpClk( SSI0_BASE, SysCtlClockGet(), SSI_FRF_MOTO_MODE_2, SSI_MODE_MASTER, ulFrequency, 8 );
+	RIT128x96x4Clear();
+}
+
+void RIT128x96x4Clear( void ) {
+	unsigned long ulRow;
+
+	g_sReplay.ulSsiBytes += 6 + 128 * 96 / 2;
+
+	for ( ulRow = 0; ulRow < REPLAY_ROWS; ulRow++ ) {
+		memset( g_sReplay.ppcScreen[ulRow], ' ', REPLAY_COLUMNS );
+		g_sReplay.ppcScreen[ulRow][REPLAY_COLUMNS] = 0;
+	}
+}
+
+void RIT128x96x4StringDraw( const char *pcStr, unsigned long ulX,
+							unsigned long ulY, unsigned char ucLevel ) {
+	unsigned long ulColumn = ulX / 6;
+	unsigned long ulRow = ulY / 8;
+
+	g_sReplay.ulSsiBytes += 10 + 24 * strlen( pcStr );
+	for ( ; *pcStr && ulColumn < REPLAY_COLUMNS && ulRow < REPLAY_ROWS; pcStr++, ulColumn++ ) {
+		g_sReplay.ppcScreen[ulRow][ulColumn] = ( *pcStr == '\n' ) ? ' ' : *pcStr;
+		g_sReplay.ulOledChars++;
+	}
+}
+
+//
+// Shown in the grid as '#' for each character cell whose middle pixel is lit
+// in the first row of the image.
+//
+void RIT128x96x4ImageDraw( const unsigned char *pucImage, unsigned long ulX,
+						   unsigned long ulY, unsigned long ulWidth, unsigned long ulHeight ) {
+	unsigned long ulRow = ulY / 8;
+	unsigned long ulPixel, ulColumn;
+	unsigned char ucByte;
+
+	g_sReplay.ulSsiBytes += 6 + ulWidth / 2 * ulHeight;
+	for ( ulPixel = 0; ulPixel < ulWidth && ulRow < REPLAY_ROWS; ulPixel++ ) {
+		ulColumn = ( ulX + ulPixel ) / 6;
+		if ( ( ulX + ulPixel ) % 6 != 3 || ulColumn >= REPLAY_COLUMNS ) {
+			continue;
+		}
+		ucByte = pucImage[ulPixel / 2];
+		g_sReplay.ppcScreen[ulRow][ulColumn] = ( ( ulPixel & 1 ) ? ucByte & 0x0F : ucByte >> 4 ) ? '#' : ' ';
+	}
+}
+
+//*****************************************************************************
+//
+//	FreeRTOS. There is only ever one task, so a take on a semaphore that is
+//	not available runs the capture forward until an ISR gives it, or waits
+//	for pty input when serving.
+//
+//*****************************************************************************
+xSemaphoreHandle ReplaySemaphoreCreate( void ) {
+	g_psSemaphores[g_ulSemaphores & 7].iGiven = 1;
+	return &g_psSemaphores[g_ulSemaphores++ & 7];
+}
+
+portBASE_TYPE xSemaphoreTake( xSemaphoreHandle xSemaphore, portTickType xBlockTime ) {
+	if ( !xSemaphore->iGiven && xBlockTime == 0 ) {
+		return pdFALSE;
+	}
+
+	// One interrupt at a time, so every give has a chance to wake the task.
+	while ( !xSemaphore->iGiven ) {
+		if ( g_iUartFd >= 0 ) {
+			ReplayUartReceive();
+			continue;
+		}
+		if ( g_ulNext >= g_ulCount ) {
+			ReplayFinish();
+		}
+		if ( g_psEvents[g_ulNext].ucType == CAPTURE_ISR ) {
+			ReplayBlocked( g_psEvents[g_ulNext].ulTick );
+			ReplayInterrupt();
+		}
+		else {
+			// The code is blocked but the capture expects it to read an input.
+			ReplayDesync();
+		}
+	}
+	ReplaySwitch( g_pcTaskName );
+	xSemaphore->iGiven = 0;
+	return pdTRUE;
+}
+
+portBASE_TYPE xSemaphoreGive( xSemaphoreHandle xSemaphore ) {
+	if ( xSemaphore->iGiven ) {
+		return pdFALSE;
+	}
+	xSemaphore->iGiven = 1;
+	return pdTRUE;
+}
+
+portBASE_TYPE xSemaphoreGiveFromISR( xSemaphoreHandle xSemaphore, portBASE_TYPE *pxWoken ) {
+	if ( xSemaphore->iGiven ) {
+		g_sReplay.ulLostGives++;
+		return pdFALSE;
+	}
+	xSemaphore->iGiven = 1;
+	*pxWoken = pdTRUE;
+	return pdTRUE;
+}
+
+void vPortYieldFromISR( void ) {
+}
+
+portBASE_TYPE xTaskCreate( pdTASK_CODE pvTaskCode, const signed char *pcName,
+						   unsigned short usStackDepth, void *pvParameters,
+						   unsigned long uxPriority, xTaskHandle *pxCreatedTask ) {
+	if ( g_ulTasks < REPLAY_TASKS ) {
+		g_psTasks[g_ulTasks].pfnTask = pvTaskCode;
+		g_psTasks[g_ulTasks++].pcName = (const char *)pcName;
+	}
+	return pdPASS;
+}
+
+void vTaskStartScheduler( void ) {
+}
+
+void vTaskDelay( portTickType xTicksToDelay ) {
+	unsigned long ulWake = xPortSysTickCount + xTicksToDelay;
+
+	while ( g_ulNext < g_ulCount && g_psEvents[g_ulNext].ucType == CAPTURE_ISR &&
+			(long)( g_psEvents[g_ulNext].ulTick - ulWake ) <= 0 ) {
+		ReplayBlocked( g_psEvents[g_ulNext].ulTick );
+		ReplayInterrupt();
+	}
+	if ( g_ulNext >= g_ulCount ) {
+		ReplayFinish();
+	}
+	ReplayBlocked( ulWake );
+	ReplaySetTick( ulWake );
+	ReplaySwitch( g_pcTaskName );
+}
+
+void vTaskDelayUntil( portTickType *pxPreviousWakeTime, portTickType xTimeIncrement ) {
+	*pxPreviousWakeTime += xTimeIncrement;
+	if ( (long)( *pxPreviousWakeTime - xPortSysTickCount ) > 0 ) {
+		vTaskDelay( *pxPreviousWakeTime - xPortSysTickCount );
+	}
+}
+
+//
+// Nothing else runs while the caller holds the processor anyway.
+//
+void vTaskSuspendAll( void ) {
+}
+
+portBASE_TYPE xTaskResumeAll( void ) {
+	return pdFALSE;
+}
+
+portTickType xTaskGetTickCount( void ) {
+	return xPortSysTickCount;
+}
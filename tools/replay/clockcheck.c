@@ -0,0 +1,314 @@
+//*****************************************************************************
+//
+//	clockcheck.c
+//
+//		Check that the lab timing holds at every clock the governor can pick
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Run the unmodified Governor.c against the replay
+//						stand-ins. Timer_0_A, UART0 and SSI0 are set up at
+//						CFG_SYSDIV as the labs do it. Then GovernorClockSet()
+//						switches to each divisor in the governor's table.
+//						After each switch the result is compared with the
+//						reference clock:
+//
+//							SysTick period
+//							Timer_0_A count rate and period
+//							UART0 baud rate error
+//							SSI0 bit rate
+//							PING delays after GovernorScale()
+//							Deadline.c microsecond timebase
+//
+//						It also checks that every other divisor is refused.
+//						Without -s this is done for the defaults and again
+//						with CFG_OLED_FREQUENCY at 4 MHz and at 100 kHz.
+//
+//		Build:			cc -O2 -I shim -o clockcheck clockcheck.c ReplayShim.c
+//							../../common/ConfigStore.c ../../common/Deadline.c
+//							../../common/Governor.c
+//						(one line)
+//
+//		Usage:			clockcheck [-s key=value]...
+//
+//						-s	override a CFG_* key and check only that
+//
+//						Exits non-zero if any check fails.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+
+#include "shim/ReplayShim.h"
+#include "../../common/ConfigStore.h"
+#include "../../common/Deadline.h"
+#include "../../common/Governor.h"
+#include "Replay.h"
+
+#define UART_BAUD				115200		// uartstdio
+#define UART_ERROR_MAX			20			// Per mille; a UART frame tolerates a few percent
+#define SSI_ERROR_MAX			100			// Per mille of the rate at the reference clock
+#define DELAY_LOOP_CYCLES		3			// Clocks per SysCtlDelay() loop
+
+extern volatile int long xPortSysTickCount;
+
+//
+// The ReplayShim.c ISR hook. Nothing is replayed here.
+//
+void Timer_0_A_ISR_Handler( void ) {
+}
+
+typedef struct
+{
+	unsigned long	ulClock;
+	unsigned long	ulTimerRate;		// Timer_0_A counts per second
+	unsigned long	ulTimerPeriodUs;
+	unsigned long	ulSsiRate;			// SSI0 bit rate the OLED gets
+	unsigned long	ulSettleNs;
+	unsigned long	ulPulseNs;
+} tClockTiming;
+
+static tClockTiming g_sReference;
+
+//*****************************************************************************
+//
+//	What is checked without -s: the defaults, then one OLED rate change each.
+//	ulRefuse is a divisor that must not be in the table.
+//
+//*****************************************************************************
+typedef struct
+{
+	unsigned long	ulKey;				// CFG_COUNT for none
+	unsigned long	ulValue;
+	unsigned long	ulRefuse;			// 0 for none
+} tClockConfig;
+
+static const tClockConfig g_psConfigs[] =
+{
+	{ CFG_COUNT,			0,			0 },
+	{ CFG_OLED_FREQUENCY,	4000000,	10 },		// 20 MHz would give the panel 5 MHz
+	{ CFG_OLED_FREQUENCY,	100000,		0 }
+};
+
+//*****************************************************************************
+//
+//	Rates the hardware ends up with, using the divisor arithmetic in
+//	UARTConfigSetExpClk() and SSIConfigSetExpClk().
+//
+//*****************************************************************************
+static unsigned long UartActual( unsigned long ulClock, unsigned long ulBaud ) {
+	unsigned long ulDiv;
+
+	// 16x oversampling with a 6 bit fractional divisor, rounded.
+	ulDiv = ( ( ( ulClock * 8 ) / ulBaud ) + 1 ) / 2;
+	return ulClock * 4 / ulDiv;
+}
+
+static unsigned long SsiActual( unsigned long ulClock, unsigned long ulBitRate ) {
+	unsigned long ulMaxBitRate, ulPreDiv, ulScr;
+
+	// Smallest even prescale for which the serial clock rate fits in 8 bits.
+	ulMaxBitRate = ulClock / ulBitRate;
+	ulPreDiv = 0;
+	do {
+		ulPreDiv += 2;
+		ulScr = ( ulMaxBitRate / ulPreDiv ) - 1;
+	} while ( ulScr > 255 );
+	return ulClock / ( ulPreDiv * ( 1 + ulScr ) );
+}
+
+static unsigned long PerMille( unsigned long ulActual, unsigned long ulWanted ) {
+	unsigned long ulDiff = ulActual > ulWanted ? ulActual - ulWanted : ulWanted - ulActual;
+
+	return ulDiff * 1000 / ulWanted;
+}
+
+static unsigned long DelayNs( unsigned long ulCount, unsigned long ulClock ) {
+	return (unsigned long)( (unsigned long long)ulCount * DELAY_LOOP_CYCLES * 1000000000ULL / ulClock );
+}
+
+static void Measure( tClockTiming *psTiming ) {
+	psTiming->ulClock = SysCtlClockGet();
+	psTiming->ulTimerRate = psTiming->ulClock / ( g_sHardware.ulTimerPrescale + 1 );
+	psTiming->ulTimerPeriodUs = (unsigned long)( (unsigned long long)g_sHardware.ulTimerLoad *
+												 ( g_sHardware.ulTimerPrescale + 1 ) * 1000000 / psTiming->ulClock );
+	psTiming->ulSsiRate = SsiActual( g_sHardware.ulSsiClock, g_sHardware.ulSsiBitRate );
+	psTiming->ulSettleNs = DelayNs( GovernorScale( ConfigGet( CFG_PING_SETTLE ) ), psTiming->ulClock );
+	psTiming->ulPulseNs = DelayNs( GovernorScale( ConfigGet( CFG_PING_PULSE ) ), psTiming->ulClock );
+}
+
+//*****************************************************************************
+//
+//	Compare the current clock with the reference. Prints one table row and
+//	the reason for each failure.
+//
+//*****************************************************************************
+static int CheckClock( void ) {
+	tClockTiming sTiming;
+	unsigned long ulBaud, ulMicros;
+	unsigned long ulSettle = ConfigGet( CFG_PING_SETTLE );
+	unsigned long ulPulse = ConfigGet( CFG_PING_PULSE );
+	int iFail = 0;
+
+	Measure( &sTiming );
+	ulBaud = UartActual( g_sHardware.ulUartClock, g_sHardware.ulUartBaud );
+
+	// One tick apart at the same SysTick count.
+	xPortSysTickCount = 1;
+	ulMicros = DeadlineMicros();
+	xPortSysTickCount = 0;
+	ulMicros -= DeadlineMicros();
+
+	printf( "%6lu %10lu %8lu %9lu %9lu %9lu %5lu %9lu %9lu %9lu\n", g_sGovernor.ulSysDiv, sTiming.ulClock,
+			( g_sHardware.uiSysTickReload + 1 ) * 1000000UL / sTiming.ulClock, sTiming.ulTimerRate,
+			sTiming.ulTimerPeriodUs, ulBaud, PerMille( ulBaud, UART_BAUD ), sTiming.ulSsiRate,
+			sTiming.ulSettleNs, sTiming.ulPulseNs );
+
+	if ( sTiming.ulClock != GOVERNOR_PLL_HZ / g_sGovernor.ulSysDiv ) {
+		printf( "  clock is not 200 MHz / %lu\n", g_sGovernor.ulSysDiv );
+		iFail = 1;
+	}
+	if ( ( g_sHardware.uiSysTickReload + 1 ) * (unsigned long)configTICK_RATE_HZ != sTiming.ulClock ) {
+		printf( "  SysTick reload %u does not give %u ticks/s\n", g_sHardware.uiSysTickReload, configTICK_RATE_HZ );
+		iFail = 1;
+	}
+	if ( ulMicros != 1000000 / configTICK_RATE_HZ ) {
+		printf( "  DeadlineMicros() reads %lu us for one tick\n", ulMicros );
+		iFail = 1;
+	}
+	if ( sTiming.ulClock % ( g_sHardware.ulTimerPrescale + 1 ) ||
+		 sTiming.ulTimerRate != g_sReference.ulTimerRate ||
+		 sTiming.ulTimerPeriodUs != g_sReference.ulTimerPeriodUs ) {
+		printf( "  Timer_0_A prescale %lu changes the count rate or period\n", g_sHardware.ulTimerPrescale );
+		iFail = 1;
+	}
+	if ( g_sHardware.ulUartClock != sTiming.ulClock || PerMille( ulBaud, UART_BAUD ) > UART_ERROR_MAX ) {
+		printf( "  UART0 runs at %lu baud from a %lu Hz clock\n", ulBaud, g_sHardware.ulUartClock );
+		iFail = 1;
+	}
+
+	// SSIConfigSetExpClk() rarely hits CFG_OLED_FREQUENCY exactly. The panel
+	// may run at the setting or at what the reference clock already gives it,
+	// whichever is faster, but no faster, and not much slower.
+	if ( g_sHardware.ulSsiClock != sTiming.ulClock ||
+		 ( sTiming.ulSsiRate > ConfigGet( CFG_OLED_FREQUENCY ) && sTiming.ulSsiRate > g_sReference.ulSsiRate ) ||
+		 PerMille( sTiming.ulSsiRate, g_sReference.ulSsiRate ) > SSI_ERROR_MAX ) {
+		printf( "  SSI0 runs at %lu Hz from a %lu Hz clock\n", sTiming.ulSsiRate, g_sHardware.ulSsiClock );
+		iFail = 1;
+	}
+
+	// Cross multiplied, so rounding in DelayNs() cannot hide a short delay.
+	if ( (unsigned long long)GovernorScale( ulSettle ) * g_sReference.ulClock < (unsigned long long)ulSettle * sTiming.ulClock ||
+		 (unsigned long long)GovernorScale( ulPulse ) * g_sReference.ulClock < (unsigned long long)ulPulse * sTiming.ulClock ) {
+		printf( "  a PING delay is shorter than calibrated\n" );
+		iFail = 1;
+	}
+	return iFail;
+}
+
+//*****************************************************************************
+//
+//	Boot as the labs do with the ulSets CFG_* overrides, switch to every
+//	divisor in the governor's table and back to the fastest, and check that
+//	every other divisor is refused. ulRefuse, if not 0, must be one of them.
+//
+//*****************************************************************************
+static int CheckConfig( unsigned long ulSets, const unsigned long *pulKey, const unsigned long *pulValue,
+						unsigned long ulRefuse ) {
+	unsigned long ulSysDiv, ulIdx;
+	int iFail = 0;
+
+	ReplayFlashBlank();
+	ConfigInit();
+	printf( "settings:" );
+	for ( ulIdx = 0; ulIdx < ulSets; ulIdx++ ) {
+		printf( " %lu=%lu", pulKey[ulIdx], pulValue[ulIdx] );
+		ConfigSet( pulKey[ulIdx], pulValue[ulIdx] );
+	}
+	printf( "%s\n", ulSets ? "" : " defaults" );
+
+	SysCtlClockSet( CONFIG_SYSCTL_SYSDIV( ConfigGet( CFG_SYSDIV ) ) | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ );
+	GovernorInit( 1, 1000, GOVERNOR_SYSDIV_MAX );
+	TimerLoadSet( TIMER0_BASE, TIMER_A, ConfigGet( CFG_TIMER_LOAD ) );
+	TimerPrescaleSet( TIMER0_BASE, TIMER_A, GovernorTimerPrescale() );
+	UARTStdioInit( 0 );
+	RIT128x96x4Init( ConfigGet( CFG_OLED_FREQUENCY ) );
+	Measure( &g_sReference );
+
+	if ( g_sGovernor.ulDivisors == 0 || g_sGovernor.pulDivisor[0] != ConfigGet( CFG_SYSDIV ) ) {
+		printf( "CFG_SYSDIV %lu is not usable, the governor stays off\n\n", ConfigGet( CFG_SYSDIV ) );
+		return 1;
+	}
+
+	printf( "%6s %10s %8s %9s %9s %9s %5s %9s %9s %9s\n", "sysdiv", "clock_hz", "tick_us", "timer_hz",
+			"timer_us", "baud", "err", "ssi_hz", "settle_ns", "pulse_ns" );
+
+	// Every usable divisor from the fastest down, then back to the fastest.
+	for ( ulIdx = 0; ulIdx <= g_sGovernor.ulDivisors; ulIdx++ ) {
+		ulSysDiv = g_sGovernor.pulDivisor[ulIdx < g_sGovernor.ulDivisors ? ulIdx : 0];
+		if ( GovernorClockSet( ulSysDiv ) != GOVERNOR_OK || g_sGovernor.ulSysDiv != ulSysDiv ) {
+			printf( "%6lu  GovernorClockSet() failed\n", ulSysDiv );
+			iFail = 1;
+			continue;
+		}
+		iFail |= CheckClock();
+	}
+
+	// Anything else must leave the clock alone.
+	printf( "refused:" );
+	for ( ulSysDiv = 1; ulSysDiv <= GOVERNOR_SYSDIV_MAX; ulSysDiv++ ) {
+		for ( ulIdx = 0; ulIdx < g_sGovernor.ulDivisors && g_sGovernor.pulDivisor[ulIdx] != ulSysDiv; ulIdx++ ) {
+		}
+		if ( ulIdx < g_sGovernor.ulDivisors ) {
+			if ( ulSysDiv == ulRefuse ) {
+				printf( " (%lu accepted)", ulSysDiv );
+				iFail = 1;
+			}
+			continue;
+		}
+		printf( " %lu", ulSysDiv );
+		if ( GovernorClockSet( ulSysDiv ) != GOVERNOR_ERR_DIVISOR || SysCtlClockGet() != g_sReference.ulClock ) {
+			printf( " (accepted)" );
+			iFail = 1;
+		}
+	}
+	printf( "\n\n" );
+	return iFail;
+}
+
+int main( int argc, char **argv ) {
+	unsigned long pulKey[CFG_COUNT], pulValue[CFG_COUNT];
+	unsigned long ulSets = 0;
+	unsigned long ulIdx;
+	int iFail = 0;
+	int iArg;
+
+	ReplayFlashBlank();
+	ConfigInit();
+
+	for ( iArg = 1; iArg + 1 < argc && !strcmp( argv[iArg], "-s" ) && ulSets < CFG_COUNT; iArg += 2, ulSets++ ) {
+		if ( sscanf( argv[iArg + 1], "%lu=%lu", &pulKey[ulSets], &pulValue[ulSets] ) != 2 ||
+			 ConfigSet( pulKey[ulSets], pulValue[ulSets] ) != CONFIG_OK ) {
+			fprintf( stderr, "clockcheck: cannot set %s\n", argv[iArg + 1] );
+			return 2;
+		}
+	}
+	if ( iArg != argc ) {
+		fprintf( stderr, "usage: %s [-s key=value]...\n", argv[0] );
+		return 2;
+	}
+
+	if ( ulSets ) {
+		iFail = CheckConfig( ulSets, pulKey, pulValue, 0 );
+	}
+	else {
+		for ( ulIdx = 0; ulIdx < sizeof( g_psConfigs ) / sizeof( g_psConfigs[0] ); ulIdx++ ) {
+			iFail |= CheckConfig( g_psConfigs[ulIdx].ulKey < CFG_COUNT, &g_psConfigs[ulIdx].ulKey,
+								  &g_psConfigs[ulIdx].ulValue, g_psConfigs[ulIdx].ulRefuse );
+		}
+	}
+
+	printf( "%s\n", iFail ? "FAIL" : "PASS" );
+	return iFail;
+}
@@ -0,0 +1,217 @@
+//*****************************************************************************
+//
+//	configtest.c
+//
+//		Power loss test of the config store on a model of the flash
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Run the unmodified ConfigStore.c against the RAM flash
+//						model in ReplayShim.c. Starting from blank flash, set
+//						random keys to random valid values. Every few sets
+//						the power is cut at a random word program or page
+//						erase, which leaves that write part done, and the
+//						store is booted again with ConfigInit(). After each
+//						boot every key must read back as last committed; the
+//						key whose set was cut may read its old or new value.
+//						Enough sets are made to compact the banks many times,
+//						so cuts land in records, headers and erases.
+//
+//						Also checks that ConfigInit() never writes flash, and
+//						reports how long it takes to scan a full bank.
+//
+//		Build:			cc -O2 -I shim -o configtest configtest.c ReplayShim.c
+//							../../common/ConfigStore.c
+//						(one line)
+//
+//		Usage:			configtest [-n sets] [-r seed]
+//
+//						Exits non-zero if any check fails.
+//
+//*****************************************************************************
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "shim/ReplayShim.h"
+#include "../../common/ConfigStore.h"
+#include "Replay.h"
+
+//*****************************************************************************
+//
+//	Before one set in CUT_ONE_IN a cut is armed at one of the next CUT_WINDOW
+//	writes, which may fall in a later set. A compaction makes up to 23 writes,
+//	its magic clear, two erases, the records and the header, so every part of
+//	it gets hit.
+//
+//*****************************************************************************
+#define CUT_ONE_IN				4
+#define CUT_WINDOW				32
+
+#define SCAN_BOOTS				1000
+
+// Limits of each key, as in ConfigStore.c. Used to pick valid values.
+static const unsigned long g_pulMin[CFG_COUNT] = { 50, 0, 4, 1, 0, 1, 1, 100000, 0 };
+static const unsigned long g_pulMax[CFG_COUNT] = { 1000, 1, 16, 0xFFFF, 0xFF, 100000, 100000, 4000000, 1 };
+
+static jmp_buf g_sCut;
+
+//
+// The ReplayShim.c ISR hook. Nothing is replayed here.
+//
+void Timer_0_A_ISR_Handler( void ) {
+}
+
+static void PowerCut( void ) {
+	longjmp( g_sCut, 1 );
+}
+
+static double Now( void ) {
+	struct timespec sTime;
+
+	clock_gettime( CLOCK_MONOTONIC, &sTime );
+	return sTime.tv_sec + sTime.tv_nsec / 1e9;
+}
+
+//*****************************************************************************
+//
+//	Boot the store and compare every key with what was committed. The key
+//	ulTorn, if below CFG_COUNT, may also read ulTornValue; whichever it reads
+//	becomes the committed value. Returns the number of mismatches.
+//
+//*****************************************************************************
+static int Boot( unsigned long *pulCommitted, unsigned long ulTorn, unsigned long ulTornValue ) {
+	unsigned long ulWrites = g_sFlash.ulWrites;
+	unsigned long ulKey, ulValue;
+	int iFail = 0;
+
+	ConfigInit();
+
+	if ( g_sFlash.ulWrites != ulWrites ) {
+		printf( "  ConfigInit() wrote flash\n" );
+		iFail++;
+	}
+	for ( ulKey = 0; ulKey < CFG_COUNT; ulKey++ ) {
+		ulValue = ConfigGet( ulKey );
+		if ( ulKey == ulTorn && ulValue == ulTornValue ) {
+			pulCommitted[ulKey] = ulValue;
+		}
+		else if ( ulValue != pulCommitted[ulKey] ) {
+			printf( "  key %lu reads %lu, %lu was committed\n", ulKey, ulValue, pulCommitted[ulKey] );
+			pulCommitted[ulKey] = ulValue;
+			iFail++;
+		}
+	}
+	return iFail;
+}
+
+int main( int argc, char **argv ) {
+	unsigned long pulCommitted[CFG_COUNT];
+	// Live across the setjmp() a power cut returns to, so kept out of registers.
+	volatile unsigned long ulSets = 100000;
+	volatile unsigned long ulCuts = 0, ulCutErases = 0, ulNewKept = 0;
+	volatile unsigned long ulIdx, ulKey, ulValue, ulErases;
+	volatile unsigned int uiSeed = 1;
+	volatile int iFail = 0;
+	unsigned long ulReads, ulSlots;
+	double dStart;
+	int iArg;
+
+	for ( iArg = 1; iArg + 1 < argc; iArg += 2 ) {
+		if ( !strcmp( argv[iArg], "-n" ) ) {
+			ulSets = strtoul( argv[iArg + 1], 0, 0 );
+		}
+		else if ( !strcmp( argv[iArg], "-r" ) ) {
+			uiSeed = strtoul( argv[iArg + 1], 0, 0 );
+		}
+		else {
+			break;
+		}
+	}
+	if ( iArg != argc ) {
+		fprintf( stderr, "usage: %s [-n sets] [-r seed]\n", argv[0] );
+		return 2;
+	}
+	srand( uiSeed );
+
+	// A blank part boots on the defaults without touching flash.
+	ReplayFlashBlank();
+	g_sFlash.pfnCut = PowerCut;
+	ConfigInit();
+	for ( ulKey = 0; ulKey < CFG_COUNT; ulKey++ ) {
+		pulCommitted[ulKey] = ConfigGet( ulKey );
+	}
+	iFail += Boot( pulCommitted, CFG_COUNT, 0 );
+	if ( g_sFlash.ulWrites ) {
+		printf( "  blank flash was written at boot\n" );
+		iFail++;
+	}
+
+	for ( ulIdx = 0; ulIdx < ulSets; ulIdx++ ) {
+		ulKey = rand() % CFG_COUNT;
+		ulValue = g_pulMin[ulKey] + rand() % ( g_pulMax[ulKey] - g_pulMin[ulKey] + 1 );
+
+		if ( !g_sFlash.ulCutAt && rand() % CUT_ONE_IN == 0 ) {
+			g_sFlash.ulCutAt = g_sFlash.ulWrites + 1 + rand() % CUT_WINDOW;
+		}
+		ulErases = g_sFlash.ulErases;
+
+		if ( setjmp( g_sCut ) == 0 ) {
+			if ( ConfigSet( ulKey, ulValue ) != CONFIG_OK ) {
+				printf( "  set %lu of key %lu to %lu failed\n", ulIdx, ulKey, ulValue );
+				iFail++;
+				continue;
+			}
+			pulCommitted[ulKey] = ulValue;
+
+			// Now and then boot without a cut as well.
+			if ( rand() % CUT_ONE_IN == 0 ) {
+				iFail += Boot( pulCommitted, CFG_COUNT, 0 );
+			}
+		}
+		else {
+			g_sFlash.ulCutAt = 0;
+			ulCuts++;
+			ulCutErases += ( g_sFlash.ulErases != ulErases );
+			iFail += Boot( pulCommitted, ulKey, ulValue );
+			ulNewKept += ( pulCommitted[ulKey] == ulValue );
+		}
+	}
+
+	printf( "sets:          %lu, seed %u\n", ulSets, uiSeed );
+	printf( "compactions:   %lu\n", g_sFlash.ulErases / 2 );
+	printf( "power cuts:    %lu (%lu during a compaction, %lu kept the new value)\n",
+			ulCuts, ulCutErases, ulNewKept );
+
+	// Worst case boot: the active bank full of records. Count the sets that
+	// fill a freshly formatted bank, then fill another one to just short of
+	// compacting.
+	g_sFlash.ulCutAt = 0;
+	ReplayFlashBlank();
+	ConfigInit();
+	ConfigSet( CFG_PING_PERIOD, 50 );
+	ulErases = g_sFlash.ulErases;
+	for ( ulSlots = 0; g_sFlash.ulErases == ulErases; ulSlots++ ) {
+		ConfigSet( CFG_PING_PERIOD, 51 + ulSlots % 2 );
+	}
+	ReplayFlashBlank();
+	ConfigInit();
+	ConfigSet( CFG_PING_PERIOD, 50 );
+	for ( ulIdx = 1; ulIdx < ulSlots; ulIdx++ ) {
+		ConfigSet( CFG_PING_PERIOD, 51 + ulIdx % 2 );
+	}
+
+	ulReads = g_sFlash.ulReads;
+	dStart = Now();
+	for ( ulIdx = 0; ulIdx < SCAN_BOOTS; ulIdx++ ) {
+		ConfigInit();
+	}
+	printf( "full bank boot: %lu records, %lu flash words read, %.2f us on this host\n",
+			ulSlots, ( g_sFlash.ulReads - ulReads ) / SCAN_BOOTS, ( Now() - dStart ) * 1e6 / SCAN_BOOTS );
+
+	printf( "%s\n", iFail ? "FAIL" : "PASS" );
+	return iFail ? 1 : 0;
+}
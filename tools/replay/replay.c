@@ -0,0 +1,270 @@
+//*****************************************************************************
+//
+//	replay.c
+//
+//		Replay a capture through the lab code on the host
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Feed the "capture:" lines dumped by Capture.c back into
+//						the unmodified ProxySensor() (lab 6) or Task_TimeOfDay()
+//						and Timer_0_A_ISR_Handler() (lab 8), deterministically
+//						and faster than real time, and report what the code did.
+//						Exits non-zero if the code and the capture fall out of
+//						step, so a saved capture works as a regression test.
+//
+//		Build:			cc -O2 -I shim -Dmain=Lab8Main -c "../../lab 8/main.c" -o lab8.o
+//						cc -O2 -I shim -o replay replay.c ReplayShim.c lab8.o
+//							"../../lab 6 sensor/ProxySensor.c" "../../lab 6 sensor/Command.c"
+//							../../common/ConfigStore.c ../../common/Capture.c
+//							../../common/Deadline.c ../../common/Display.c
+//							../../common/Governor.c ../../common/Trace.c
+//						(the second command is one line). Add -DTRACE_ENABLE
+//						to both for the trace points and -t.
+//
+//		Usage:			replay [-v] [-t] [-n repeat] [-s key=value]... sensor|clock <log>
+//						replay [-s key=value]... serve
+//
+//						serve runs lab 6's command task with UART0 on a pty
+//						and prints the pty's name, for tools/cmdclient; see
+//						servetest.sh.
+//
+//						-v	print what the code sends to UART0
+//						-t	print the trace of the last run as "trace:"
+//							lines, for tools/trace2json
+//						-n	replay the capture this many times (for timing; the
+//							lab code's own statics carry over between runs)
+//						-s	override a CFG_* key before the run
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "shim/ReplayShim.h"
+#include "../../common/ConfigStore.h"
+#include "../../common/Deadline.h"
+#include "../../common/Display.h"
+#include "../../common/Governor.h"
+#include "../../common/Trace.h"
+#include "../../lab 6 sensor/Command.h"
+#include "Replay.h"
+
+//*****************************************************************************
+//
+//	Frame periods of the display compositor, DISPLAY_TASK_PERIOD_MS in each
+//	lab's TaskSet.h.
+//
+//*****************************************************************************
+#define SENSOR_FRAME_MS			100
+#define CLOCK_FRAME_MS			50
+
+extern void ProxySensor( void *pvParameters );
+extern void Task_TimeOfDay( void *pvParameters );
+
+static double Now( void ) {
+	struct timespec sTime;
+
+	clock_gettime( CLOCK_MONOTONIC, &sTime );
+	return sTime.tv_sec + sTime.tv_nsec / 1e9;
+}
+
+//*****************************************************************************
+//
+//	Read every "capture: tick timer type value" line in a serial log.
+//
+//*****************************************************************************
+static tCaptureEvent *LoadCapture( const char *pcPath, unsigned long *pulCount ) {
+	tCaptureEvent *psEvents = 0;
+	tCaptureEvent *psGrown;
+	unsigned long ulSize = 0;
+	unsigned int uiTick, uiTimer, uiType, uiValue;
+	char pcLine[256];
+	char *pcField;
+	FILE *pFile;
+
+	pFile = fopen( pcPath, "r" );
+	if ( !pFile ) {
+		perror( pcPath );
+		return 0;
+	}
+
+	*pulCount = 0;
+	while ( fgets( pcLine, sizeof( pcLine ), pFile ) ) {
+		pcField = strstr( pcLine, "capture: " );
+		if ( !pcField || sscanf( pcField + 9, "%x %x %x %x", &uiTick, &uiTimer, &uiType, &uiValue ) != 4 ) {
+			continue;
+		}
+		if ( *pulCount == ulSize ) {
+			ulSize = ulSize ? ulSize * 2 : CAPTURE_EVENTS;
+			psGrown = realloc( psEvents, ulSize * sizeof( tCaptureEvent ) );
+			if ( !psGrown ) {
+				fprintf( stderr, "replay: out of memory at %lu events of %s\n", *pulCount, pcPath );
+				free( psEvents );
+				fclose( pFile );
+				return 0;
+			}
+			psEvents = psGrown;
+		}
+		psEvents[*pulCount].ulTick = uiTick;
+		psEvents[*pulCount].usTimer = uiTimer;
+		psEvents[*pulCount].ucType = uiType;
+		psEvents[*pulCount].ucValue = uiValue;
+		( *pulCount )++;
+	}
+	fclose( pFile );
+
+	if ( *pulCount == 0 ) {
+		fprintf( stderr, "replay: no capture lines in %s\n", pcPath );
+	}
+	return psEvents;
+}
+
+int main( int argc, char **argv ) {
+	void ( *pfnTask )( void * );
+	const char *pcTaskName;
+	unsigned long ulFrameMs;
+	tCaptureEvent *psEvents;
+	unsigned long ulCount;
+	unsigned long ulKey, ulValue;
+	unsigned long ulRow;
+	double dStart, dHost, dSpan;
+	int iRepeat = 1;
+	int bVerbose;
+	int iArg, iRun;
+#ifdef TRACE_ENABLE
+	int bTrace = 0;
+#endif
+
+	ReplayFlashBlank();
+	ConfigInit();
+
+	// SysTick counts host time within each tick, so spans and response times
+	// are not rounded down to whole ticks.
+	g_sReplay.bHostTime = 1;
+
+	for ( iArg = 1; iArg < argc && argv[iArg][0] == '-'; iArg++ ) {
+		if ( !strcmp( argv[iArg], "-v" ) ) {
+			g_sReplay.bVerbose = 1;
+		}
+#ifdef TRACE_ENABLE
+		else if ( !strcmp( argv[iArg], "-t" ) ) {
+			bTrace = 1;
+		}
+#endif
+		else if ( !strcmp( argv[iArg], "-n" ) && iArg + 1 < argc ) {
+			iRepeat = atoi( argv[++iArg] );
+		}
+		else if ( !strcmp( argv[iArg], "-s" ) && iArg + 1 < argc &&
+				  sscanf( argv[++iArg], "%lu=%lu", &ulKey, &ulValue ) == 2 ) {
+			if ( ConfigSet( ulKey, ulValue ) != CONFIG_OK ) {
+				fprintf( stderr, "replay: cannot set key %lu to %lu\n", ulKey, ulValue );
+				return 2;
+			}
+		}
+		else {
+			break;
+		}
+	}
+	if ( argc - iArg == 1 && !strcmp( argv[iArg], "serve" ) ) {
+		CommandInit( 1 );
+		GovernorInit( 1, 1000, GOVERNOR_SYSDIV_MAX );
+#ifdef TRACE_ENABLE
+		TraceStart();
+#endif
+		return ReplayServe( ReplayTask( "Command" ), "Command" ) ? 1 : 0;
+	}
+	if ( argc - iArg != 2 || iRepeat < 1 ) {
+		fprintf( stderr, "usage: %s [-v] [-t] [-n repeat] [-s key=value]... sensor|clock <log>\n"
+						 "       %s [-s key=value]... serve\n", argv[0], argv[0] );
+		return 2;
+	}
+
+	if ( !strcmp( argv[iArg], "sensor" ) ) {
+		// Sets up the UART lock ProxySensor() prints under, as lab 6 main() does.
+		CommandInit( 1 );
+		pfnTask = ProxySensor;
+		pcTaskName = "ProxySensor";
+		ulFrameMs = SENSOR_FRAME_MS;
+	}
+	else if ( !strcmp( argv[iArg], "clock" ) ) {
+		pfnTask = Task_TimeOfDay;
+		pcTaskName = "Task_TimeOfDay";
+		ulFrameMs = CLOCK_FRAME_MS;
+	}
+	else {
+		fprintf( stderr, "replay: unknown target %s\n", argv[iArg] );
+		return 2;
+	}
+
+	// The clock stays at CFG_SYSDIV, as it was when the capture was taken; the
+	// governor task is not run.
+	GovernorInit( 1, 1000, GOVERNOR_SYSDIV_MAX );
+
+	psEvents = LoadCapture( argv[iArg + 1], &ulCount );
+	if ( !psEvents ) {
+		return 1;
+	}
+
+	// The compositor draws between the task's jobs, as its lower priority would allow.
+	DisplayInit( 1, ulFrameMs );
+	ReplayBackground( DisplayFrame, ulFrameMs, "Display" );
+
+	// Each run restarts the task from its entry point with fresh statistics.
+	dStart = Now();
+	for ( iRun = 0; iRun < iRepeat; iRun++ ) {
+		memset( &g_sReplay, 0, offsetof( tReplayStats, bVerbose ) );
+		memset( (void *)&g_sCommandStats, 0, sizeof( g_sCommandStats ) );
+		memset( (void *)&g_sDisplayStats, 0, sizeof( g_sDisplayStats ) );
+#ifdef TRACE_ENABLE
+		TraceStart();
+#endif
+		ReplayRun( psEvents, ulCount, pfnTask, pcTaskName );
+	}
+
+	// A run that never blocks, as with -s forcing an overload, leaves no room
+	// for frames; one more shows the last posted state on the screen.
+	DisplayFrame();
+	dHost = ( Now() - dStart ) / iRepeat;
+	dSpan = ( psEvents[ulCount - 1].ulTick - psEvents[0].ulTick ) / (double)configTICK_RATE_HZ;
+
+	printf( "events:        %lu of %lu\n", g_sReplay.ulEvents, ulCount );
+	printf( "captured span: %.3f s\n", dSpan );
+	printf( "replay time:   %.6f s per run (%.0fx real time)\n", dHost, dHost > 0 ? dSpan / dHost : 0 );
+	printf( "desyncs:       %lu\n", g_sReplay.ulDesyncs );
+	printf( "interrupts:    %lu (%lu semaphore gives lost)\n", g_sReplay.ulInterrupts, g_sReplay.ulLostGives );
+	printf( "uart lines:    %lu\n", g_sReplay.ulUartLines );
+	printf( "oled chars:    %lu\n", g_sReplay.ulOledChars );
+
+	// The driver busy waits on SSI, so the compositor's CPU time is its bytes at the SSI clock.
+	printf( "ssi:           %lu bytes, %.0f bytes/s\n", g_sReplay.ulSsiBytes, g_sReplay.ulSsiBytes / dSpan );
+	printf( "display cpu:   %.2f%% at %lu Hz SSI (%lu updates, %lu coalesced)\n",
+			g_sReplay.ulSsiBytes * 8.0 * 100 / ConfigGet( CFG_OLED_FREQUENCY ) / dSpan,
+			ConfigGet( CFG_OLED_FREQUENCY ), g_sDisplayStats.ulMessages,
+			g_sDisplayStats.ulCoalesced );
+
+	if ( pfnTask == ProxySensor ) {
+		printf( "pings:         %lu\n", g_sCommandStats.ulPings );
+		printf( "last echo:     %lu timer counts\n", g_sCommandStats.ulLastEcho );
+	}
+	for ( ulRow = 0; ulRow < REPLAY_ROWS; ulRow++ ) {
+		printf( "  |%s|\n", g_sReplay.ppcScreen[ulRow] );
+	}
+
+	// Response times: the ticks a job spans on the captured timeline plus
+	// host time within the last one.
+	bVerbose = g_sReplay.bVerbose;
+	g_sReplay.bVerbose = 1;
+	DeadlineReport();
+#ifdef TRACE_ENABLE
+	if ( bTrace ) {
+		TraceDump();
+	}
+#endif
+	g_sReplay.bVerbose = bVerbose;
+
+	free( psEvents );
+	return g_sReplay.ulDesyncs ? 1 : 0;
+}
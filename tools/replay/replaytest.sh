@@ -0,0 +1,61 @@
+#!/bin/sh
+#*****************************************************************************
+#
+#	replaytest.sh
+#
+#		Replay the saved captures as regression tests
+#
+#		Organization:	KU/EECS/EECS 388
+#
+#		Purpose:		Build replay and tools/rmsched, replay each capture in
+#						captures/ through its lab's code and check the replay
+#						stayed in step with it (no desyncs) and that the
+#						measured response times pass rmsched against the
+#						lab's TaskSet.h. sensor*.log captures replay lab 6,
+#						clock*.log captures lab 8. Exits non-zero if any
+#						capture fails.
+#
+#		Usage:			sh replaytest.sh
+#
+#*****************************************************************************
+
+cd "$(dirname "$0")" || exit 2
+
+CC=${CC:-cc}
+DIR=$(mktemp -d) || exit 2
+FAILED=0
+
+trap 'rm -rf "$DIR"' EXIT
+
+$CC -O2 -I shim -Dmain=Lab8Main -c "../../lab 8/main.c" -o "$DIR/lab8.o" &&
+$CC -O2 -I shim -o "$DIR/replay" replay.c ReplayShim.c "$DIR/lab8.o" \
+	"../../lab 6 sensor/ProxySensor.c" "../../lab 6 sensor/Command.c" \
+	../../common/ConfigStore.c ../../common/Capture.c \
+	../../common/Deadline.c ../../common/Display.c \
+	../../common/Governor.c ../../common/Trace.c &&
+$CC -O2 -o "$DIR/rmsched" ../rmsched.c -lm || exit 2
+
+#
+# check <sensor|clock> <TaskSet.h> <capture>
+#
+check() {
+	MODE=$1 TASKSET=$2 CAPTURE=$3
+	if "$DIR/replay" "$MODE" "$CAPTURE" > "$DIR/out" 2>&1 &&
+	   grep -q "^desyncs: *0$" "$DIR/out" &&
+	   "$DIR/rmsched" "$TASKSET" "$DIR/out" > "$DIR/sched" 2>&1; then
+		echo "PASS $CAPTURE: $(grep "^deadline:" "$DIR/out" | tr '\n' ' ')"
+	else
+		echo "FAIL $CAPTURE"
+		sed 's/^/    /' "$DIR/out" "$DIR/sched" 2>/dev/null
+		FAILED=$((FAILED + 1))
+	fi
+}
+
+for CAPTURE in captures/sensor*.log; do
+	[ -e "$CAPTURE" ] && check sensor "../../lab 6 sensor/TaskSet.h" "$CAPTURE"
+done
+for CAPTURE in captures/clock*.log; do
+	[ -e "$CAPTURE" ] && check clock "../../lab 8/TaskSet.h" "$CAPTURE"
+done
+
+exit $FAILED
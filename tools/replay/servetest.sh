@@ -0,0 +1,91 @@
+#!/bin/sh
+#*****************************************************************************
+#
+#	servetest.sh
+#
+#		Run tools/cmdclient against lab 6's command task on a pty
+#
+#		Organization:	KU/EECS/EECS 388
+#
+#		Purpose:		Build replay and cmdclient, start "replay serve" and
+#						run ping, get, set, the error replies, the stream
+#						commands, stats, deadlines and bench through the
+#						unmodified Command.c. The average bench round trip
+#						must beat the same frames at 115200 baud, so the
+#						command task is never what limits the link. Exits
+#						non-zero if any case fails.
+#
+#		Usage:			sh servetest.sh [bench count]
+#
+#*****************************************************************************
+
+cd "$(dirname "$0")" || exit 2
+
+CC=${CC:-cc}
+COUNT=${1:-1000}
+DIR=$(mktemp -d) || exit 2
+SERVER=
+FAILED=0
+
+trap '[ -n "$SERVER" ] && kill $SERVER 2>/dev/null; rm -rf "$DIR"' EXIT
+
+$CC -O2 -I shim -Dmain=Lab8Main -c "../../lab 8/main.c" -o "$DIR/lab8.o" &&
+$CC -O2 -I shim -o "$DIR/replay" replay.c ReplayShim.c "$DIR/lab8.o" \
+	"../../lab 6 sensor/ProxySensor.c" "../../lab 6 sensor/Command.c" \
+	../../common/ConfigStore.c ../../common/Capture.c \
+	../../common/Deadline.c ../../common/Display.c \
+	../../common/Governor.c ../../common/Trace.c &&
+$CC -O2 -o "$DIR/cmdclient" ../cmdclient.c || exit 2
+
+"$DIR/replay" serve > "$DIR/pty" &
+SERVER=$!
+for TRY in 1 2 3 4 5 6 7 8 9 10; do
+	PTY=$(head -n 1 "$DIR/pty")
+	[ -n "$PTY" ] && break
+	sleep 0.1
+done
+if [ -z "$PTY" ]; then
+	echo "servetest: replay serve did not start"
+	exit 1
+fi
+
+#
+# check <name> <expected exit status> <pattern expected in the output> <cmdclient arguments>...
+#
+check() {
+	NAME=$1 STATUS=$2 PATTERN=$3
+	shift 3
+	"$DIR/cmdclient" "$PTY" "$@" > "$DIR/out" 2>&1
+	RESULT=$?
+	if [ $RESULT -eq "$STATUS" ] && grep -q -- "$PATTERN" "$DIR/out"; then
+		echo "PASS $NAME"
+	else
+		echo "FAIL $NAME (exit $RESULT)"
+		sed 's/^/    /' "$DIR/out"
+		FAILED=$((FAILED + 1))
+	fi
+}
+
+check ping				0	"^ok$"					ping
+check get				0	"^0 = 60$"				get 0
+check set				0	"^0 = 100$"				set 0 100
+check "get after set"	0	"^0 = 100$"				get 0
+check "set range"		1	"error status 0x04"		set 0 5
+check "get param"		1	"error status 0x03"		get 42
+check stop				0	"^ok$"					stop
+check "stop not saved"	0	"^1 = 1$"				get 1
+check start				0	"^ok$"					start
+check stats				0	"^frames_ok"			stats
+check deadlines			0	"^deadline: Command"	deadlines
+check "bench count"		2	"at least 1"			bench 0
+check bench				0	"^round trips: $COUNT$"	bench "$COUNT"
+cat "$DIR/out"
+if awk '/^latency ms:/ { avg = $6 } / baud: / { wire = $3 }
+		END { exit !( avg != "" && wire != "" && avg + 0 < wire + 0 ) }' "$DIR/out"; then
+	echo "PASS bench latency"
+else
+	echo "FAIL bench latency: average round trip not below the 115200 baud time"
+	FAILED=$((FAILED + 1))
+fi
+
+exit $FAILED
@@ -0,0 +1,271 @@
+//*****************************************************************************
+//
+//	ReplayShim.h
+//
+//		Host stand-ins for the StellarisWare and FreeRTOS calls the lab code
+//		makes, driven by a recorded capture
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Notes:			Every driverlib/FreeRTOS header name the lab code
+//						includes is a one line file in this directory that
+//						pulls in this header. Only what the replayed files use
+//						is declared. Register addresses are the LM3S1968 ones
+//						but are never dereferenced.
+//
+//*****************************************************************************
+
+#ifndef __REPLAYSHIM_H__
+#define __REPLAYSHIM_H__
+
+#include <stddef.h>
+
+//*****************************************************************************
+//
+//	Compiler and hw_types.h
+//
+//*****************************************************************************
+#define __interrupt
+
+typedef unsigned char tBoolean;
+#ifndef true
+#define true					1
+#define false					0
+#endif
+
+#define HWREG( x )				( *ReplayRegister( x ) )
+extern volatile unsigned int *ReplayRegister( unsigned long ulAddress );
+
+//*****************************************************************************
+//
+//	hw_memmap.h, hw_ints.h, hw_nvic.h, hw_sysctl.h
+//
+//*****************************************************************************
+#define GPIO_PORTA_BASE			0x40004000
+#define GPIO_PORTD_BASE			0x40007000
+#define GPIO_PORTG_BASE			0x40026000
+#define UART0_BASE				0x4000C000
+#define SSI0_BASE				0x40008000
+#define TIMER0_BASE				0x40030000
+
+#define INT_UART0				21
+#define INT_TIMER0A				35
+
+#define NVIC_ST_RELOAD			0xE000E014
+#define NVIC_ST_CURRENT			0xE000E018
+#define NVIC_INT_CTRL			0xE000ED04
+#define NVIC_INT_CTRL_PEND_SYST	0x04000000
+
+#define SYSCTL_RCC				0x400FE060
+#define SYSCTL_RCC_SYSDIV_M		0x07800000
+#define SYSCTL_RCC_USESYSDIV	0x00400000
+#define SYSCTL_RCC_SYSDIV_S		23
+#define SYSCTL_RCGC1			0x400FE104
+#define SYSCTL_RCGC1_TIMER0		0x00010000
+#define SYSCTL_RCGC1_SSI0		0x00000010
+#define SYSCTL_RCGC1_UART0		0x00000001
+
+//*****************************************************************************
+//
+//	sysctl.h
+//
+//*****************************************************************************
+#define SYSCTL_PERIPH_GPIOA		0x20000001
+#define SYSCTL_PERIPH_GPIOD		0x20000008
+#define SYSCTL_PERIPH_GPIOG		0x20000040
+#define SYSCTL_PERIPH_UART0		0x10000001
+#define SYSCTL_PERIPH_TIMER0	0x10100001
+
+#define SYSCTL_SYSDIV_4			0x01C00000
+#define SYSCTL_USE_PLL			0x00000000
+#define SYSCTL_OSC_MAIN			0x00000000
+#define SYSCTL_XTAL_8MHZ		0x00000380
+
+extern void SysCtlPeripheralEnable( unsigned long ulPeripheral );
+extern void SysCtlPeripheralDisable( unsigned long ulPeripheral );
+extern void SysCtlPeripheralReset( unsigned long ulPeripheral );
+extern void SysCtlClockSet( unsigned long ulConfig );
+extern unsigned long SysCtlClockGet( void );
+extern void SysCtlDelay( unsigned long ulCount );
+extern void SysCtlSleep( void );
+
+//*****************************************************************************
+//
+//	gpio.h
+//
+//*****************************************************************************
+#define GPIO_PIN_0				0x01
+#define GPIO_PIN_1				0x02
+#define GPIO_PIN_2				0x04
+#define GPIO_PIN_7				0x80
+
+#define GPIO_STRENGTH_2MA		0x00000001
+#define GPIO_PIN_TYPE_STD		0x00000008
+#define GPIO_PIN_TYPE_STD_WPU	0x0000000A
+#define GPIO_PIN_TYPE_OD		0x00000009
+
+extern void GPIOPinTypeGPIOInput( unsigned long ulPort, unsigned char ucPins );
+extern void GPIOPinTypeGPIOOutput( unsigned long ulPort, unsigned char ucPins );
+extern void GPIOPinTypeUART( unsigned long ulPort, unsigned char ucPins );
+extern void GPIOPadConfigSet( unsigned long ulPort, unsigned char ucPins,
+							  unsigned long ulStrength, unsigned long ulPadType );
+extern long GPIOPinRead( unsigned long ulPort, unsigned char ucPins );
+extern void GPIOPinWrite( unsigned long ulPort, unsigned char ucPins, unsigned char ucVal );
+
+//*****************************************************************************
+//
+//	timer.h
+//
+//*****************************************************************************
+#define TIMER_A					0x000000FF
+#define TIMER_CFG_SPLIT_PAIR	0x04000000
+#define TIMER_CFG_A_PERIODIC	0x00000002
+#define TIMER_TIMA_TIMEOUT		0x00000001
+
+extern void TimerConfigure( unsigned long ulBase, unsigned long ulConfig );
+extern void TimerEnable( unsigned long ulBase, unsigned long ulTimer );
+extern void TimerLoadSet( unsigned long ulBase, unsigned long ulTimer, unsigned long ulValue );
+extern void TimerPrescaleSet( unsigned long ulBase, unsigned long ulTimer, unsigned long ulValue );
+extern unsigned long TimerPrescaleGet( unsigned long ulBase, unsigned long ulTimer );
+extern unsigned long TimerValueGet( unsigned long ulBase, unsigned long ulTimer );
+extern void TimerIntEnable( unsigned long ulBase, unsigned long ulIntFlags );
+extern void TimerIntClear( unsigned long ulBase, unsigned long ulIntFlags );
+
+//*****************************************************************************
+//
+//	interrupt.h
+//
+//*****************************************************************************
+extern void IntEnable( unsigned long ulInterrupt );
+extern void IntPrioritySet( unsigned long ulInterrupt, unsigned char ucPriority );
+extern tBoolean IntMasterDisable( void );
+extern tBoolean IntMasterEnable( void );
+
+//*****************************************************************************
+//
+//	cpu.h
+//
+//*****************************************************************************
+extern unsigned long CPUcpsid( void );
+extern unsigned long CPUcpsie( void );
+
+//*****************************************************************************
+//
+//	uart.h, uartstdio.h
+//
+//*****************************************************************************
+#define UART_INT_RX				0x010
+#define UART_INT_RT				0x040
+#define UART_CONFIG_WLEN_8		0x00000060
+#define UART_CONFIG_STOP_ONE	0x00000000
+#define UART_CONFIG_PAR_NONE	0x00000000
+
+extern void UARTIntRegister( unsigned long ulBase, void ( *pfnHandler )( void ) );
+extern void UARTIntEnable( unsigned long ulBase, unsigned long ulIntFlags );
+extern void UARTIntClear( unsigned long ulBase, unsigned long ulIntFlags );
+extern unsigned long UARTIntStatus( unsigned long ulBase, tBoolean bMasked );
+extern tBoolean UARTCharsAvail( unsigned long ulBase );
+extern long UARTCharGetNonBlocking( unsigned long ulBase );
+extern void UARTCharPut( unsigned long ulBase, unsigned char ucData );
+extern tBoolean UARTBusy( unsigned long ulBase );
+extern void UARTConfigSetExpClk( unsigned long ulBase, unsigned long ulUARTClk,
+								 unsigned long ulBaud, unsigned long ulConfig );
+extern void UARTStdioInit( unsigned long ulPort );
+extern void UARTprintf( const char *pcString, ... );
+
+//*****************************************************************************
+//
+//	ustdlib.h
+//
+//*****************************************************************************
+extern int usnprintf( char *pcBuf, unsigned long ulSize, const char *pcString, ... );
+
+//*****************************************************************************
+//
+//	ssi.h
+//
+//*****************************************************************************
+#define SSI_FRF_MOTO_MODE_2		0x00000002
+#define SSI_MODE_MASTER			0x00000000
+
+extern void SSIConfigSetExpClk( unsigned long ulBase, unsigned long ulSSIClk,
+								unsigned long ulProtocol, unsigned long ulMode,
+								unsigned long ulBitRate, unsigned long ulDataWidth );
+extern void SSIEnable( unsigned long ulBase );
+extern void SSIDisable( unsigned long ulBase );
+extern tBoolean SSIBusy( unsigned long ulBase );
+
+//*****************************************************************************
+//
+//	flash.h
+//
+//*****************************************************************************
+extern long FlashErase( unsigned long ulAddress );
+extern long FlashProgram( unsigned long *pulData, unsigned long ulAddress, unsigned long ulCount );
+extern void FlashUsecSet( unsigned long ulClocks );
+
+//*****************************************************************************
+//
+//	rit128x96x4.h
+//
+//*****************************************************************************
+extern void RIT128x96x4Init( unsigned long ulFrequency );
+extern void RIT128x96x4Clear( void );
+extern void RIT128x96x4StringDraw( const char *pcStr, unsigned long ulX,
+								   unsigned long ulY, unsigned char ucLevel );
+extern void RIT128x96x4ImageDraw( const unsigned char *pucImage, unsigned long ulX,
+								  unsigned long ulY, unsigned long ulWidth, unsigned long ulHeight );
+
+//*****************************************************************************
+//
+//	FreeRTOS
+//
+//*****************************************************************************
+#define portCHAR				char
+#define portBASE_TYPE			long
+#define portTickType			unsigned long
+#define portMAX_DELAY			( portTickType )0xFFFFFFFF
+#define portTICK_RATE_MS		( ( portTickType )1 )
+#define configTICK_RATE_HZ		1000
+#define configKERNEL_INTERRUPT_PRIORITY	255
+#define tskIDLE_PRIORITY		0
+#define pdFALSE					0
+#define pdTRUE					1
+#define pdPASS					1
+
+// One thread runs everything, so a critical section has nothing to exclude.
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define portSET_INTERRUPT_MASK_FROM_ISR()			0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )		( ( void )( x ) )
+
+typedef struct
+{
+	int iGiven;
+} tReplaySemaphore;
+
+typedef tReplaySemaphore *xSemaphoreHandle;
+typedef void *xTaskHandle;
+typedef void ( *pdTASK_CODE )( void * );
+
+extern xSemaphoreHandle ReplaySemaphoreCreate( void );
+
+#define vSemaphoreCreateBinary( xSemaphore )	( xSemaphore ) = ReplaySemaphoreCreate()
+#define xSemaphoreCreateMutex()					ReplaySemaphoreCreate()
+
+extern portBASE_TYPE xSemaphoreTake( xSemaphoreHandle xSemaphore, portTickType xBlockTime );
+extern portBASE_TYPE xSemaphoreGive( xSemaphoreHandle xSemaphore );
+extern portBASE_TYPE xSemaphoreGiveFromISR( xSemaphoreHandle xSemaphore, portBASE_TYPE *pxWoken );
+extern void vPortYieldFromISR( void );
+
+extern portBASE_TYPE xTaskCreate( pdTASK_CODE pvTaskCode, const signed char *pcName,
+								  unsigned short usStackDepth, void *pvParameters,
+								  unsigned long uxPriority, xTaskHandle *pxCreatedTask );
+extern void vTaskStartScheduler( void );
+extern void vTaskDelay( portTickType xTicksToDelay );
+extern void vTaskDelayUntil( portTickType *pxPreviousWakeTime, portTickType xTimeIncrement );
+extern void vTaskSuspendAll( void );
+extern portBASE_TYPE xTaskResumeAll( void );
+extern portTickType xTaskGetTickCount( void );
+
+#endif // __REPLAYSHIM_H__
@@ -0,0 +1,2 @@
+// Replay stand-in, see ReplayShim.h
+#include "ReplayShim.h"
@@ -0,0 +1,339 @@
+//*****************************************************************************
+//
+//	rmsched.c
+//
+//		Rate monotonic schedulability check for a lab's TaskSet.h
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Read the NAME_TASK_PERIOD_MS, NAME_TASK_WCET_US,
+//						NAME_TASK_PRIORITY and optional NAME_TASK_BLOCK_US
+//						defines from a TaskSet.h, check the priorities are rate
+//						monotonic, and run the utilisation (Liu and Layland)
+//						and exact response time tests. Given
+//						a serial log with the "deadline:" lines printed by
+//						Deadline.c (or by tools/replay), also compare the
+//						measured response times and misses with the analysis.
+//
+//		Build:			cc -O2 -o rmsched rmsched.c -lm
+//
+//		Usage:			rmsched <TaskSet.h> [deadline.log]
+//
+//						Exits non-zero if the set is not schedulable, the
+//						priorities are not rate monotonic, or the log shows a
+//						late job, a lost release or a response time above the
+//						analysed bound.
+//
+//*****************************************************************************
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TASKS				16
+#define MAX_NAME				32
+
+typedef struct
+{
+	char			pcName[MAX_NAME];
+	unsigned long	ulPeriodUs;
+	unsigned long	ulWcetUs;
+	long			lPriority;
+	unsigned long	ulBlockUs;			// Longest a higher priority task can wait on this one
+	unsigned long	ulResponseUs;		// Analysed worst case, 0 if unbounded
+	int				bMeasured;
+} tTask;
+
+static tTask g_psTasks[MAX_TASKS];
+static int g_iTasks;
+
+static tTask *FindTask( const char *pcName ) {
+	int iIdx;
+
+	for ( iIdx = 0; iIdx < g_iTasks; iIdx++ ) {
+		if ( !strcmp( g_psTasks[iIdx].pcName, pcName ) ) {
+			return &g_psTasks[iIdx];
+		}
+	}
+	if ( g_iTasks == MAX_TASKS ) {
+		return 0;
+	}
+	strcpy( g_psTasks[g_iTasks].pcName, pcName );
+	return &g_psTasks[g_iTasks++];
+}
+
+//*****************************************************************************
+//
+//	Task names are compared without case or underscores, so "TimeOfDay" in
+//	the log matches TIMEOFDAY in TaskSet.h.
+//
+//*****************************************************************************
+static int SameName( const char *pcA, const char *pcB ) {
+	while ( *pcA || *pcB ) {
+		if ( *pcA == '_' ) {
+			pcA++;
+			continue;
+		}
+		if ( *pcB == '_' ) {
+			pcB++;
+			continue;
+		}
+		if ( toupper( (unsigned char)*pcA ) != toupper( (unsigned char)*pcB ) ) {
+			return 0;
+		}
+		pcA++;
+		pcB++;
+	}
+	return 1;
+}
+
+//*****************************************************************************
+//
+//	The value of a define is the last integer on its line, so a priority of
+//	( tskIDLE_PRIORITY + 2 ) reads as 2.
+//
+//*****************************************************************************
+static int LoadTaskSet( const char *pcPath ) {
+	char pcLine[256], pcName[MAX_NAME + 32];
+	char *pcSuffix, *pcScan;
+	long lValue;
+	tTask *psTask;
+	FILE *pFile;
+
+	pFile = fopen( pcPath, "r" );
+	if ( !pFile ) {
+		perror( pcPath );
+		return -1;
+	}
+
+	while ( fgets( pcLine, sizeof( pcLine ), pFile ) ) {
+		if ( sscanf( pcLine, " #define %63s", pcName ) != 1 ) {
+			continue;
+		}
+		pcSuffix = strstr( pcName, "_TASK_" );
+		if ( !pcSuffix || pcSuffix - pcName >= MAX_NAME ) {
+			continue;
+		}
+
+		lValue = -1;
+		for ( pcScan = pcLine + strlen( pcLine ); pcScan > pcLine; pcScan-- ) {
+			if ( isdigit( (unsigned char)pcScan[-1] ) ) {
+				while ( pcScan > pcLine && isdigit( (unsigned char)pcScan[-1] ) ) {
+					pcScan--;
+				}
+				lValue = strtol( pcScan, 0, 10 );
+				break;
+			}
+		}
+		if ( lValue < 0 ) {
+			continue;
+		}
+
+		*pcSuffix = 0;
+		psTask = FindTask( pcName );
+		if ( !psTask ) {
+			fprintf( stderr, "rmsched: more than %d tasks\n", MAX_TASKS );
+			fclose( pFile );
+			return -1;
+		}
+		if ( !strcmp( pcSuffix + 6, "PERIOD_MS" ) ) {
+			psTask->ulPeriodUs = lValue * 1000;
+		}
+		else if ( !strcmp( pcSuffix + 6, "WCET_US" ) ) {
+			psTask->ulWcetUs = lValue;
+		}
+		else if ( !strcmp( pcSuffix + 6, "PRIORITY" ) ) {
+			psTask->lPriority = lValue;
+		}
+		else if ( !strcmp( pcSuffix + 6, "BLOCK_US" ) ) {
+			psTask->ulBlockUs = lValue;
+		}
+	}
+	fclose( pFile );
+
+	if ( g_iTasks == 0 ) {
+		fprintf( stderr, "rmsched: no NAME_TASK_ defines in %s\n", pcPath );
+		return -1;
+	}
+	return 0;
+}
+
+//*****************************************************************************
+//
+//	Blocking: with priority inheritance each lower priority task can hold a
+//	task up at most once per job, for its BLOCK_US (a critical section, a
+//	suspended scheduler, a mutex or a flash stall), so B is their sum.
+//
+//*****************************************************************************
+static unsigned long Blocking( const tTask *psTask ) {
+	unsigned long ulBlock = 0;
+	int iIdx;
+
+	for ( iIdx = 0; iIdx < g_iTasks; iIdx++ ) {
+		if ( g_psTasks[iIdx].lPriority < psTask->lPriority ) {
+			ulBlock += g_psTasks[iIdx].ulBlockUs;
+		}
+	}
+	return ulBlock;
+}
+
+//*****************************************************************************
+//
+//	Exact test: R = C + B + sum over higher or equal priority tasks j of
+//	ceil(R / Tj) * Cj, iterated to a fixed point. Equal priorities are
+//	counted as interference since FreeRTOS round robins them.
+//
+//*****************************************************************************
+static unsigned long ResponseTime( const tTask *psTask ) {
+	unsigned long ulResponse, ulNext;
+	unsigned long ulBlock = Blocking( psTask );
+	int iIdx;
+
+	ulNext = psTask->ulWcetUs + ulBlock;
+	do {
+		ulResponse = ulNext;
+		ulNext = psTask->ulWcetUs + ulBlock;
+		for ( iIdx = 0; iIdx < g_iTasks; iIdx++ ) {
+			if ( &g_psTasks[iIdx] != psTask && g_psTasks[iIdx].lPriority >= psTask->lPriority ) {
+				ulNext += ( ( ulResponse + g_psTasks[iIdx].ulPeriodUs - 1 ) / g_psTasks[iIdx].ulPeriodUs ) *
+						  g_psTasks[iIdx].ulWcetUs;
+			}
+		}
+		if ( ulNext > psTask->ulPeriodUs ) {
+			return 0;
+		}
+	} while ( ulNext != ulResponse );
+
+	return ulResponse;
+}
+
+//*****************************************************************************
+//
+//	Check each "deadline: name period_ms max_response_us late lost jobs"
+//	line against the analysis. The last line for a task wins, since the
+//	counters only grow.
+//
+//*****************************************************************************
+static int CheckLog( const char *pcPath ) {
+	char pcLine[256], pcName[MAX_NAME];
+	unsigned long ulPeriod, ulResponse, ulLate, ulLost, ulJobs;
+	tTask *psTask;
+	char *pcField;
+	int iFail = 0;
+	int iIdx;
+	FILE *pFile;
+	struct { unsigned long ulResponse, ulLate, ulLost, ulJobs; } psLast[MAX_TASKS];
+
+	pFile = fopen( pcPath, "r" );
+	if ( !pFile ) {
+		perror( pcPath );
+		return 1;
+	}
+
+	while ( fgets( pcLine, sizeof( pcLine ), pFile ) ) {
+		pcField = strstr( pcLine, "deadline: " );
+		if ( !pcField || sscanf( pcField + 10, "%31s %lu %lu %lu %lu %lu", pcName, &ulPeriod,
+								 &ulResponse, &ulLate, &ulLost, &ulJobs ) != 6 ) {
+			continue;
+		}
+		for ( iIdx = 0; iIdx < g_iTasks && !SameName( g_psTasks[iIdx].pcName, pcName ); iIdx++ ) {
+		}
+		if ( iIdx == g_iTasks ) {
+			printf( "log: %s is not in the task set\n", pcName );
+			iFail = 1;
+			continue;
+		}
+		psTask = &g_psTasks[iIdx];
+		if ( ulPeriod * 1000 != psTask->ulPeriodUs ) {
+			printf( "log: %s runs with a %lu ms period, the analysis assumes %lu ms\n",
+					psTask->pcName, ulPeriod, psTask->ulPeriodUs / 1000 );
+		}
+		psTask->bMeasured = 1;
+		psLast[iIdx].ulResponse = ulResponse;
+		psLast[iIdx].ulLate = ulLate;
+		psLast[iIdx].ulLost = ulLost;
+		psLast[iIdx].ulJobs = ulJobs;
+	}
+	fclose( pFile );
+
+	printf( "\n%-12s %10s %10s %6s %6s %8s\n", "measured", "resp_us", "bound_us", "late", "lost", "jobs" );
+	for ( iIdx = 0; iIdx < g_iTasks; iIdx++ ) {
+		psTask = &g_psTasks[iIdx];
+		if ( !psTask->bMeasured ) {
+			printf( "%-12s %10s\n", psTask->pcName, "-" );
+			continue;
+		}
+		printf( "%-12s %10lu %10lu %6lu %6lu %8lu", psTask->pcName, psLast[iIdx].ulResponse,
+				psTask->ulResponseUs, psLast[iIdx].ulLate, psLast[iIdx].ulLost, psLast[iIdx].ulJobs );
+		if ( psLast[iIdx].ulLate || psLast[iIdx].ulLost ) {
+			printf( "  DEADLINE MISSED" );
+			iFail = 1;
+		}
+		else if ( psTask->ulResponseUs && psLast[iIdx].ulResponse > psTask->ulResponseUs ) {
+			printf( "  ABOVE BOUND, WCET too low" );
+			iFail = 1;
+		}
+		printf( "\n" );
+	}
+	return iFail;
+}
+
+int main( int argc, char **argv ) {
+	double dUtilisation = 0, dBound;
+	tTask *psTask;
+	int iFail = 0;
+	int iIdx, iOther;
+
+	if ( argc < 2 || argc > 3 ) {
+		fprintf( stderr, "usage: %s <TaskSet.h> [deadline.log]\n", argv[0] );
+		return 2;
+	}
+	if ( LoadTaskSet( argv[1] ) ) {
+		return 2;
+	}
+
+	printf( "%-12s %10s %10s %4s %6s %10s %10s\n", "task", "period_us", "wcet_us", "prio", "util", "block_us", "resp_us" );
+	for ( iIdx = 0; iIdx < g_iTasks; iIdx++ ) {
+		psTask = &g_psTasks[iIdx];
+		if ( psTask->ulPeriodUs == 0 ) {
+			fprintf( stderr, "rmsched: %s has no period\n", psTask->pcName );
+			return 2;
+		}
+		dUtilisation += (double)psTask->ulWcetUs / psTask->ulPeriodUs;
+		psTask->ulResponseUs = ResponseTime( psTask );
+
+		printf( "%-12s %10lu %10lu %4ld %6.3f %10lu ", psTask->pcName, psTask->ulPeriodUs,
+				psTask->ulWcetUs, psTask->lPriority, (double)psTask->ulWcetUs / psTask->ulPeriodUs,
+				Blocking( psTask ) );
+		if ( psTask->ulResponseUs ) {
+			printf( "%10lu\n", psTask->ulResponseUs );
+		}
+		else {
+			printf( "%10s  MISSES DEADLINE\n", "-" );
+			iFail = 1;
+		}
+
+		for ( iOther = 0; iOther < g_iTasks; iOther++ ) {
+			if ( g_psTasks[iOther].ulPeriodUs > psTask->ulPeriodUs &&
+				 g_psTasks[iOther].lPriority >= psTask->lPriority ) {
+				printf( "  not rate monotonic: %s (%lu us) is not below %s (%lu us)\n",
+						g_psTasks[iOther].pcName, g_psTasks[iOther].ulPeriodUs,
+						psTask->pcName, psTask->ulPeriodUs );
+				iFail = 1;
+			}
+		}
+	}
+
+	dBound = g_iTasks * ( pow( 2.0, 1.0 / g_iTasks ) - 1 );
+	printf( "\nutilisation %.3f, Liu and Layland bound for %d tasks %.3f: %s\n", dUtilisation, g_iTasks, dBound,
+			dUtilisation <= dBound ? "schedulable" : dUtilisation <= 1 ? "bound exceeded, see resp_us" : "overloaded" );
+
+	if ( argc == 3 ) {
+		iFail |= CheckLog( argv[2] );
+	}
+
+	printf( "\n%s\n", iFail ? "FAIL" : "PASS" );
+	return iFail;
+}
@@ -0,0 +1,356 @@
+//*****************************************************************************
+//
+//	trace2json.c
+//
+//		Convert the "trace:" lines printed by Trace.c to Chrome trace JSON
+//
+//		Organization:	KU/EECS/EECS 388
+//
+//		Purpose:		Read a serial log holding one or more trace dumps
+//						(cmdclient trace, the lab 8 console, or replay -t) and
+//						write Chrome trace event JSON for Perfetto
+//						(ui.perfetto.dev) or chrome://tracing. The "CPU" track
+//						shows which task or ISR was running, ISRs nested in
+//						the task they interrupted. Each task and ISR also has
+//						a track of its own for its spans and marks. Clock
+//						changes are marks across all tracks.
+//
+//		Build:			cc -O2 -o trace2json trace2json.c
+//
+//		Usage:			trace2json <log> [trace.json]
+//
+//						Writes to stdout without a second argument. Spans
+//						whose start was overwritten in the ring are dropped;
+//						spans still open at the end of a dump are closed there.
+//						Times are the uS TraceDump() worked out, carried on
+//						past the 32 bit wrap, and task names come from the
+//						dump's "task" lines.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_IDS					256			// ISRs and spans, and tasks named in the log
+#define MAX_NAME				32
+#define MAX_NESTING				16
+
+#define EVENT_TASK				1			// Trace.h TRACE_EVENT_*
+#define EVENT_ISR_ENTER			2
+#define EVENT_ISR_EXIT			3
+#define EVENT_BEGIN				4
+#define EVENT_END				5
+#define EVENT_MARK				6
+#define EVENT_CLOCK				7
+
+//
+// Track ids: the CPU, then one per task, then one per ISR.
+//
+#define TID_CPU					0
+#define TID_TASK( ulId )		( 1 + ( ulId ) )
+#define TID_ISR( ulId )			( 1 + MAX_IDS + ( ulId ) )
+#define TID_UNKNOWN				( 1 + 2 * MAX_IDS )		// Before the first task switch in a dump
+#define TIDS					( TID_UNKNOWN + 1 )
+
+static char g_ppcTasks[MAX_IDS][MAX_NAME];
+static unsigned long g_pulTaskNames[MAX_IDS];	// The name pointer each task is known by
+static unsigned long g_ulTasks;
+static char g_ppcIsrs[MAX_IDS][MAX_NAME];
+static char g_ppcSpans[MAX_IDS][MAX_NAME];
+
+static FILE *g_pOut;
+static int g_bFirst = 1;
+
+// Where the current dump stands
+static unsigned long g_ulLastUs;
+static double g_dWrapUs;					// 2^32 uS for each time the count wrapped
+static double g_dLast;
+static long g_lTask;						// Running task id, -1 if not known yet
+static double g_dTaskStart;
+static unsigned long g_pulIsr[MAX_NESTING];
+static double g_pdIsrStart[MAX_NESTING];
+static int g_iIsrs;
+static int g_piOpen[TIDS];					// Spans begun and not ended, per track
+static int g_pbUsed[TIDS];
+
+//*****************************************************************************
+//
+//	JSON output. Each event is one line of the traceEvents array.
+//
+//*****************************************************************************
+static void PutString( const char *pcString ) {
+	fputc( '"', g_pOut );
+	for ( ; *pcString; pcString++ ) {
+		if ( *pcString == '"' || *pcString == '\\' ) {
+			fputc( '\\', g_pOut );
+		}
+		if ( (unsigned char)*pcString >= ' ' ) {
+			fputc( *pcString, g_pOut );
+		}
+	}
+	fputc( '"', g_pOut );
+}
+
+static void Event( const char *pcPhase, int iTid, const char *pcName, double dTs ) {
+	fprintf( g_pOut, "%s\n{\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":",
+			 g_bFirst ? "" : ",", pcPhase, iTid, dTs );
+	PutString( pcName );
+	g_bFirst = 0;
+	g_pbUsed[iTid] = 1;
+}
+
+static void Slice( int iTid, const char *pcName, double dStart, double dEnd ) {
+	Event( "X", iTid, pcName, dStart );
+	fprintf( g_pOut, ",\"dur\":%.3f}", dEnd - dStart );
+}
+
+static void Metadata( int iTid, const char *pcName, int iOrder ) {
+	fprintf( g_pOut, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", iTid );
+	PutString( pcName );
+	fprintf( g_pOut, "}}" );
+	fprintf( g_pOut, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%d}}",
+			 iTid, iOrder );
+}
+
+static const char *Name( char ppcNames[][MAX_NAME], unsigned long ulId, const char *pcKind ) {
+	static char pcName[MAX_NAME + 16];
+
+	if ( ppcNames[ulId][0] ) {
+		return ppcNames[ulId];
+	}
+	sprintf( pcName, "%s %lu", pcKind, ulId );
+	return pcName;
+}
+
+//*****************************************************************************
+//
+//	The task id for a name pointer. One the dump did not name gets the
+//	pointer as its name.
+//
+//*****************************************************************************
+static unsigned long TaskId( unsigned long ulName ) {
+	unsigned long ulId;
+
+	for ( ulId = 0; ulId < g_ulTasks && g_pulTaskNames[ulId] != ulName; ulId++ ) {
+	}
+	if ( ulId == g_ulTasks ) {
+		if ( g_ulTasks == MAX_IDS ) {
+			return MAX_IDS - 1;
+		}
+		g_pulTaskNames[ulId] = ulName;
+		sprintf( g_ppcTasks[ulId], "task %08lx", ulName );
+		g_ulTasks++;
+	}
+	return ulId;
+}
+
+//*****************************************************************************
+//
+//	The track user events go to: the innermost ISR, else the running task.
+//
+//*****************************************************************************
+static int Context( void ) {
+	if ( g_iIsrs ) {
+		return TID_ISR( g_pulIsr[g_iIsrs - 1] );
+	}
+	return g_lTask < 0 ? TID_UNKNOWN : TID_TASK( g_lTask );
+}
+
+//*****************************************************************************
+//
+//	Close everything still open at the last event of a dump.
+//
+//*****************************************************************************
+static void EndDump( void ) {
+	int iTid;
+
+	while ( g_iIsrs ) {
+		g_iIsrs--;
+		Slice( TID_CPU, Name( g_ppcIsrs, g_pulIsr[g_iIsrs], "isr" ), g_pdIsrStart[g_iIsrs], g_dLast );
+	}
+	if ( g_lTask >= 0 ) {
+		Slice( TID_CPU, Name( g_ppcTasks, g_lTask, "task" ), g_dTaskStart, g_dLast );
+		g_lTask = -1;
+	}
+	for ( iTid = 0; iTid < TIDS; iTid++ ) {
+		for ( ; g_piOpen[iTid]; g_piOpen[iTid]-- ) {
+			Event( "E", iTid, "", g_dLast );
+			fprintf( g_pOut, "}" );
+		}
+	}
+}
+
+static void TraceEvent( unsigned long ulUs, unsigned long ulType, unsigned long ulArg ) {
+	char pcClock[32];
+	unsigned long ulId;
+	double dTs;
+	int iTid;
+
+	// The target counts uS in 32 bits, which wrap every 71 minutes.
+	if ( ulUs < g_ulLastUs && g_ulLastUs - ulUs > 0x80000000 ) {
+		g_dWrapUs += 4294967296.0;
+	}
+	g_ulLastUs = ulUs;
+	dTs = g_dWrapUs + ulUs;
+	if ( dTs < g_dLast ) {
+		dTs = g_dLast;
+	}
+	g_dLast = dTs;
+
+	// Everything but a task switch and a clock change carries an id.
+	ulId = ulArg & ( MAX_IDS - 1 );
+
+	switch ( ulType ) {
+	case EVENT_TASK:
+		if ( g_lTask >= 0 ) {
+			Slice( TID_CPU, Name( g_ppcTasks, g_lTask, "task" ), g_dTaskStart, dTs );
+		}
+		g_lTask = TaskId( ulArg );
+		g_dTaskStart = dTs;
+		break;
+
+	case EVENT_ISR_ENTER:
+		if ( g_iIsrs < MAX_NESTING ) {
+			g_pulIsr[g_iIsrs] = ulId;
+			g_pdIsrStart[g_iIsrs++] = dTs;
+		}
+		break;
+
+	case EVENT_ISR_EXIT:
+		// An exit whose entry was overwritten has nothing to close.
+		if ( g_iIsrs && g_pulIsr[g_iIsrs - 1] == ulId ) {
+			g_iIsrs--;
+			Slice( TID_CPU, Name( g_ppcIsrs, ulId, "isr" ), g_pdIsrStart[g_iIsrs], dTs );
+		}
+		break;
+
+	case EVENT_BEGIN:
+		iTid = Context();
+		Event( "B", iTid, Name( g_ppcSpans, ulId, "span" ), dTs );
+		fprintf( g_pOut, "}" );
+		g_piOpen[iTid]++;
+		break;
+
+	case EVENT_END:
+		iTid = Context();
+		if ( g_piOpen[iTid] ) {
+			Event( "E", iTid, Name( g_ppcSpans, ulId, "span" ), dTs );
+			fprintf( g_pOut, "}" );
+			g_piOpen[iTid]--;
+		}
+		break;
+
+	case EVENT_MARK:
+		Event( "i", Context(), Name( g_ppcSpans, ulId, "mark" ), dTs );
+		fprintf( g_pOut, ",\"s\":\"t\"}" );
+		break;
+
+	case EVENT_CLOCK:
+		sprintf( pcClock, "clock %.1f MHz", ulArg / 1e6 );
+		Event( "i", TID_CPU, pcClock, dTs );
+		fprintf( g_pOut, ",\"s\":\"g\",\"args\":{\"hz\":%lu}}", ulArg );
+		break;
+	}
+}
+
+int main( int argc, char **argv ) {
+	unsigned long ulUs, ulType, ulArg, ulId;
+	unsigned long ulCount, ulLost, ulTickHz;
+	unsigned long ulEvents = 0, ulOverwritten = 0, ulDumps = 0;
+	char pcLine[256], pcName[MAX_NAME];
+	char *pcField;
+	int bInDump = 0;
+	int iTid;
+	FILE *pIn;
+
+	if ( argc < 2 || argc > 3 ) {
+		fprintf( stderr, "usage: %s <log> [trace.json]\n", argv[0] );
+		return 2;
+	}
+	pIn = fopen( argv[1], "r" );
+	if ( !pIn ) {
+		perror( argv[1] );
+		return 2;
+	}
+	g_pOut = argc == 3 ? fopen( argv[2], "w" ) : stdout;
+	if ( !g_pOut ) {
+		perror( argv[2] );
+		return 2;
+	}
+
+	fprintf( g_pOut, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" );
+	g_lTask = -1;
+
+	while ( fgets( pcLine, sizeof( pcLine ), pIn ) ) {
+		pcField = strstr( pcLine, "trace: " );
+		if ( !pcField ) {
+			continue;
+		}
+		pcField += 7;
+		pcField[strcspn( pcField, "\r\n" )] = 0;
+
+		if ( sscanf( pcField, "begin %lu %lu %lu", &ulCount, &ulLost, &ulTickHz ) == 3 ) {
+			if ( bInDump ) {
+				EndDump();
+			}
+			g_ulLastUs = 0;
+			g_dWrapUs = 0;
+			g_dLast = 0;
+			ulOverwritten += ulLost;
+			ulDumps++;
+			bInDump = 1;
+		}
+		else if ( sscanf( pcField, "task %lx %31[^\n]", &ulArg, pcName ) == 2 ) {
+			strcpy( g_ppcTasks[TaskId( ulArg )], pcName );
+		}
+		else if ( sscanf( pcField, "isr %lu %31[^\n]", &ulId, pcName ) == 2 && ulId < MAX_IDS ) {
+			strcpy( g_ppcIsrs[ulId], pcName );
+		}
+		else if ( sscanf( pcField, "span %lu %31[^\n]", &ulId, pcName ) == 2 && ulId < MAX_IDS ) {
+			strcpy( g_ppcSpans[ulId], pcName );
+		}
+		else if ( !strcmp( pcField, "end" ) ) {
+			if ( bInDump ) {
+				EndDump();
+			}
+			bInDump = 0;
+		}
+		else if ( bInDump && sscanf( pcField, "%lu %lu %lx", &ulUs, &ulType, &ulArg ) == 3 ) {
+			TraceEvent( ulUs, ulType, ulArg );
+			ulEvents++;
+		}
+	}
+	if ( bInDump ) {
+		EndDump();
+	}
+	fclose( pIn );
+
+	// Name the tracks that were used: CPU first, then tasks, then ISRs.
+	fprintf( g_pOut, "%s\n{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"LM3S1968\"}}",
+			 g_bFirst ? "" : "," );
+	Metadata( TID_CPU, "CPU", 0 );
+	for ( iTid = 1; iTid < TIDS; iTid++ ) {
+		if ( !g_pbUsed[iTid] ) {
+			continue;
+		}
+		if ( iTid == TID_UNKNOWN ) {
+			Metadata( iTid, "before first switch", iTid );
+		}
+		else if ( iTid >= TID_ISR( 0 ) ) {
+			sprintf( pcName, "ISR %.26s", Name( g_ppcIsrs, iTid - TID_ISR( 0 ), "isr" ) );
+			Metadata( iTid, pcName, iTid );
+		}
+		else {
+			Metadata( iTid, Name( g_ppcTasks, iTid - TID_TASK( 0 ), "task" ), iTid );
+		}
+	}
+	fprintf( g_pOut, "\n]}\n" );
+	if ( g_pOut != stdout ) {
+		fclose( g_pOut );
+	}
+
+	fprintf( stderr, "trace2json: %lu events from %lu dumps, %lu overwritten before the oldest\n",
+			 ulEvents, ulDumps, ulOverwritten );
+	return ulDumps ? 0 : 1;
+}